@@ -0,0 +1,405 @@
+#include <lib/bst.cpp>
+#include <lib/btree.cpp>
+#include <lib/compact_bst.cpp>
+#include <lib/persistent_bst.cpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <set>
+#include <span>
+
+#include "workloads.h"
+
+using Tree = BinarySearchTree<int, std::less<int>, CountingAllocator<int>>;
+using Set = std::set<int, std::less<int>, CountingAllocator<int>>;
+using BTreeSet = BTree<int, std::less<int>, CountingAllocator<int>>;
+using CompactTree = CompactBinarySearchTree<int, std::less<int>, CountingAllocator<int>>;
+using PersistentTree = PersistentBinarySearchTree<int, std::less<int>, CountingAllocator<int>>;
+
+void ReportPerOperation(benchmark::State& state, size_t operations) {
+    state.SetItemsProcessed(state.iterations() * operations);
+    state.counters["time/op"] = benchmark::Counter(operations, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+// каждый прогон, где контейнер живет на CountingAllocator, показывает байты на элемент - их сравнивают с std::set
+template<typename Container>
+void ReportBytesPerElement(benchmark::State& state, const Container& container, size_t bytes_before) {
+    state.counters["bytes/elem"] = container.empty() ? 0 : static_cast<double>(allocated_bytes - bytes_before) / container.size();
+}
+
+template<typename Container, typename Distribution>
+void BM_Insert(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Distribution{}, state.range(0));
+    for (auto _: state) {
+        size_t bytes_before = allocated_bytes;
+        auto container = std::make_unique<Container>();
+        for (int key: keys) {
+            container->insert(key);
+        }
+
+        state.PauseTiming();
+        ReportBytesPerElement(state, *container, bytes_before);
+        container.reset();
+        state.ResumeTiming();
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+// подсказка - конец контейнера, как для почти отсортированного потока событий
+template<typename Container, typename Distribution>
+void BM_InsertHint(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Distribution{}, state.range(0));
+    for (auto _: state) {
+        size_t bytes_before = allocated_bytes;
+        auto container = std::make_unique<Container>();
+        for (int key: keys) {
+            container->insert(container->end(), key);
+        }
+
+        state.PauseTiming();
+        ReportBytesPerElement(state, *container, bytes_before);
+        container.reset();
+        state.ResumeTiming();
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+template<typename Container, typename Distribution>
+void BM_Find(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Container container(keys.begin(), keys.end());
+    ReportBytesPerElement(state, container, bytes_before);
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        for (int key: queries) {
+            benchmark::DoNotOptimize(container.find(key));
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+template<typename Distribution>
+void BM_CursorFind(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Tree tree(keys.begin(), keys.end());
+    ReportBytesPerElement(state, tree, bytes_before);
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        auto cursor = tree.cursor();
+        for (int key: queries) {
+            benchmark::DoNotOptimize(cursor.find(key));
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+// ключи ищутся пачками по kBatch, как при соединении по ключу
+template<typename Distribution>
+void BM_FindMany(benchmark::State& state) {
+    constexpr size_t kBatch = 4096;
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Tree tree(keys.begin(), keys.end());
+    ReportBytesPerElement(state, tree, bytes_before);
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+    std::vector<decltype(tree.end())> result(kBatch);
+
+    for (auto _: state) {
+        for (size_t start = 0; start < queries.size(); start += kBatch) {
+            size_t count = std::min(kBatch, queries.size() - start);
+            tree.find_many(std::span(queries).subspan(start, count), std::span(result));
+            benchmark::DoNotOptimize(result.data());
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+template<typename Container, typename Distribution>
+void BM_LowerBound(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    for (int& key: keys) {
+        key *= 2;
+    }
+    size_t bytes_before = allocated_bytes;
+    Container container(keys.begin(), keys.end());
+    ReportBytesPerElement(state, container, bytes_before);
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        for (int key: queries) {
+            benchmark::DoNotOptimize(container.lower_bound(key * 2 + 1));
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+template<typename Container, typename Distribution>
+void BM_Erase(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    std::vector<int> erased = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        state.PauseTiming();
+        size_t bytes_before = allocated_bytes;
+        auto container = std::make_unique<Container>(keys.begin(), keys.end());
+        ReportBytesPerElement(state, *container, bytes_before);
+        state.ResumeTiming();
+
+        for (int key: erased) {
+            container->erase(key);
+        }
+
+        state.PauseTiming();
+        container.reset();
+        state.ResumeTiming();
+    }
+    ReportPerOperation(state, erased.size());
+}
+
+template<typename traversal_type>
+void BM_TraverseTree(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Tree tree(keys.begin(), keys.end());
+    ReportBytesPerElement(state, tree, bytes_before);
+
+    for (auto _: state) {
+        long long sum = 0;
+        for (auto it = tree.begin<traversal_type>(); it != tree.end<traversal_type>(); ++it) {
+            sum += *it;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+void BM_TraverseSet(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Set set(keys.begin(), keys.end());
+    ReportBytesPerElement(state, set, bytes_before);
+
+    for (auto _: state) {
+        long long sum = 0;
+        for (int key: set) {
+            sum += key;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+// объединение двух деревьев по n ключей: union_with против вставок по одному ключу
+template<bool kUnionWith>
+void BM_Union(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    std::vector<int> other_keys = MakeKeys(Uniform{}, state.range(0), 7);
+    Tree other(other_keys.begin(), other_keys.end());
+
+    for (auto _: state) {
+        state.PauseTiming();
+        size_t bytes_before = allocated_bytes;
+        auto tree = std::make_unique<Tree>(keys.begin(), keys.end());
+        state.ResumeTiming();
+
+        if constexpr (kUnionWith) {
+            tree->union_with(other);
+        } else {
+            for (int key: other) {
+                tree->insert(key);
+            }
+        }
+
+        state.PauseTiming();
+        ReportBytesPerElement(state, *tree, bytes_before);
+        tree.reset();
+        state.ResumeTiming();
+    }
+    ReportPerOperation(state, other_keys.size());
+}
+
+template<typename Container>
+void BM_Copy(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    Container container(keys.begin(), keys.end());
+
+    for (auto _: state) {
+        size_t bytes_before = allocated_bytes;
+        auto copy = std::make_unique<Container>(container);
+        benchmark::DoNotOptimize(copy->size());
+
+        state.PauseTiming();
+        ReportBytesPerElement(state, *copy, bytes_before);
+        copy.reset();
+        state.ResumeTiming();
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+// читателю нужен снимок на момент вставки: изменяемому дереву - полная копия, неизменяемому - общая версия
+template<typename Container>
+void BM_SnapshotInsert(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    size_t bytes_before = allocated_bytes;
+    Container container(keys.begin(), keys.end());
+    ReportBytesPerElement(state, container, bytes_before);
+    int next = state.range(0);
+
+    for (auto _: state) {
+        Container snapshot = container;
+        if constexpr (std::is_same_v<Container, PersistentTree>) {
+            container = container.insert(next++);
+        } else {
+            container.insert(next++);
+        }
+        benchmark::DoNotOptimize(snapshot.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Container>
+void BM_Clear(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+
+    for (auto _: state) {
+        state.PauseTiming();
+        size_t bytes_before = allocated_bytes;
+        Container container(keys.begin(), keys.end());
+        ReportBytesPerElement(state, container, bytes_before);
+        state.ResumeTiming();
+
+        container.clear();
+        benchmark::DoNotOptimize(container.size());
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+// обход и разрушение на пуле из range(1) потоков. Дерево на std::allocator: CountingAllocator не потокобезопасен
+void BM_ParallelReduce(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    BinarySearchTree<int> tree(keys.begin(), keys.end());
+    WorkStealingPool pool(state.range(1));
+
+    for (auto _: state) {
+        long long sum = tree.parallel_reduce(0LL, std::plus<>(), std::identity{}, pool);
+        benchmark::DoNotOptimize(sum);
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+void BM_ParallelClear(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    WorkStealingPool pool(state.range(1));
+
+    for (auto _: state) {
+        state.PauseTiming();
+        BinarySearchTree<int> tree(keys.begin(), keys.end());
+        state.ResumeTiming();
+
+        tree.clear(pool);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    ReportPerOperation(state, keys.size());
+}
+
+template<typename Frozen>
+Frozen MakeFrozen(std::vector<int> keys, SimdLevel level) {
+    std::sort(keys.begin(), keys.end());
+    Frozen frozen(assume_sorted, keys.begin(), keys.end());
+    if constexpr (requires { frozen.set_simd_level(level); }) {
+        frozen.set_simd_level(level);
+    }
+    return frozen;
+}
+
+// второй аргумент - SimdLevel для StaticBTree
+template<typename Frozen, typename Distribution>
+void BM_FrozenFind(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    Frozen frozen = MakeFrozen<Frozen>(keys, static_cast<SimdLevel>(state.range(1)));
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        for (int key: queries) {
+            benchmark::DoNotOptimize(frozen.find(key));
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+template<typename Frozen, typename Distribution>
+void BM_FrozenLowerBound(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    for (int& key: keys) {
+        key *= 2;
+    }
+    Frozen frozen = MakeFrozen<Frozen>(keys, static_cast<SimdLevel>(state.range(1)));
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        for (int key: queries) {
+            benchmark::DoNotOptimize(frozen.lower_bound(key * 2 + 1));
+        }
+    }
+    ReportPerOperation(state, queries.size());
+}
+
+#define SIZES ->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)
+
+#define CONTAINER_BENCHMARKS(Container)                                      \
+    BENCHMARK_TEMPLATE(BM_Insert, Container, Sequential) SIZES;              \
+    BENCHMARK_TEMPLATE(BM_Insert, Container, Uniform) SIZES;                 \
+    BENCHMARK_TEMPLATE(BM_Insert, Container, Zipfian) SIZES;                 \
+    BENCHMARK_TEMPLATE(BM_Insert, Container, Midpoint) SIZES;                \
+    BENCHMARK_TEMPLATE(BM_Find, Container, Sequential) SIZES;                \
+    BENCHMARK_TEMPLATE(BM_Find, Container, Uniform) SIZES;                   \
+    BENCHMARK_TEMPLATE(BM_Find, Container, Zipfian) SIZES;                   \
+    BENCHMARK_TEMPLATE(BM_Find, Container, Midpoint) SIZES;                  \
+    BENCHMARK_TEMPLATE(BM_LowerBound, Container, Uniform) SIZES;             \
+    BENCHMARK_TEMPLATE(BM_LowerBound, Container, Zipfian) SIZES;             \
+    BENCHMARK_TEMPLATE(BM_Erase, Container, Sequential) SIZES;               \
+    BENCHMARK_TEMPLATE(BM_Erase, Container, Uniform) SIZES;                  \
+    BENCHMARK_TEMPLATE(BM_Copy, Container) SIZES;                            \
+    BENCHMARK_TEMPLATE(BM_Clear, Container) SIZES;
+
+CONTAINER_BENCHMARKS(Tree)
+CONTAINER_BENCHMARKS(Set)
+CONTAINER_BENCHMARKS(BTreeSet)
+CONTAINER_BENCHMARKS(CompactTree)
+
+BENCHMARK_TEMPLATE(BM_TraverseTree, InOrder) SIZES;
+BENCHMARK_TEMPLATE(BM_TraverseTree, PreOrder) SIZES;
+BENCHMARK_TEMPLATE(BM_TraverseTree, PostOrder) SIZES;
+BENCHMARK(BM_TraverseSet) SIZES;
+BENCHMARK_TEMPLATE(BM_SnapshotInsert, Tree) SIZES;
+BENCHMARK_TEMPLATE(BM_SnapshotInsert, PersistentTree) SIZES;
+BENCHMARK_TEMPLATE(BM_InsertHint, Tree, Sequential) SIZES;
+BENCHMARK_TEMPLATE(BM_InsertHint, Set, Sequential) SIZES;
+BENCHMARK_TEMPLATE(BM_CursorFind, Sequential) SIZES;
+BENCHMARK_TEMPLATE(BM_CursorFind, Uniform) SIZES;
+BENCHMARK_TEMPLATE(BM_Union, true) SIZES;
+BENCHMARK_TEMPLATE(BM_Union, false) SIZES;
+BENCHMARK_TEMPLATE(BM_FindMany, Uniform) SIZES;
+BENCHMARK_TEMPLATE(BM_FindMany, Zipfian) SIZES;
+
+#define PARALLEL_SIZES ->ArgsProduct({{1000000, 10000000}, {1, 2, 4, 8, 16}})->Unit(benchmark::kMillisecond)->UseRealTime()
+
+BENCHMARK(BM_ParallelReduce) PARALLEL_SIZES;
+BENCHMARK(BM_ParallelClear) PARALLEL_SIZES;
+
+#define FROZEN_SIZES(...) ->ArgsProduct({benchmark::CreateRange(1000, 10000000, 10), {__VA_ARGS__}})->Unit(benchmark::kMillisecond)
+#define EYTZINGER FROZEN_SIZES(0)
+#define SIMD_LEVELS FROZEN_SIZES(0, 1, 2)
+
+using Eytzinger = FrozenBinarySearchTree<int>;
+using SimdIndex = StaticBTree<int>;
+
+BENCHMARK_TEMPLATE(BM_FrozenFind, Eytzinger, Sequential) EYTZINGER;
+BENCHMARK_TEMPLATE(BM_FrozenFind, Eytzinger, Uniform) EYTZINGER;
+BENCHMARK_TEMPLATE(BM_FrozenFind, Eytzinger, Zipfian) EYTZINGER;
+BENCHMARK_TEMPLATE(BM_FrozenLowerBound, Eytzinger, Uniform) EYTZINGER;
+BENCHMARK_TEMPLATE(BM_FrozenFind, SimdIndex, Uniform) SIMD_LEVELS;
+BENCHMARK_TEMPLATE(BM_FrozenLowerBound, SimdIndex, Uniform) SIMD_LEVELS;
@@ -0,0 +1,101 @@
+#include <lib/bst.cpp>
+#include <lib/concurrent_bst.cpp>
+#include <lib/sharded_bst.cpp>
+#include <benchmark/benchmark.h>
+#include <mutex>
+
+#include "workloads.h"
+
+// как общий BinarySearchTree используется сейчас: каждый вызов под внешним мьютексом
+class LockedTree {
+public:
+    bool contains(int key) const {
+        std::lock_guard lock(mutex_);
+        return tree_.contains(key);
+    }
+
+    void insert(int key) {
+        std::lock_guard lock(mutex_);
+        tree_.insert(key);
+    }
+
+    size_t erase(int key) {
+        std::lock_guard lock(mutex_);
+        return tree_.erase(key);
+    }
+
+private:
+    BinarySearchTree<int> tree_;
+    mutable std::mutex mutex_;
+};
+
+using Concurrent = ConcurrentBinarySearchTree<int>;
+using Sharded = ShardedBinarySearchTree<int>;
+
+constexpr size_t kSharedSize = 1000000;
+
+template<typename Shared>
+Shared& SharedTree() {
+    static Shared* tree = [] {
+        auto* tree = new Shared();
+        for (int key: MakeKeys(Uniform{}, kSharedSize)) {
+            tree->insert(key * 2);
+        }
+        if constexpr (requires { tree->rebalance(); }) {
+            tree->rebalance();
+        }
+        return tree;
+    }();
+    return *tree;
+}
+
+// все потоки ищут; при kWithWriter нулевой поток вместо поиска вставляет и удаляет нечетные ключи
+template<typename Shared, bool kWithWriter>
+void BM_SharedFind(benchmark::State& state) {
+    Shared& tree = SharedTree<Shared>();
+    std::vector<int> queries = MakeKeys(Uniform{}, kSharedSize, 7 + state.thread_index());
+    bool writer = kWithWriter && state.thread_index() == 0;
+
+    size_t position = 0;
+    for (auto _: state) {
+        int key = queries[position];
+        position = position + 1 == queries.size() ? 0 : position + 1;
+        if (writer) {
+            tree.insert(key * 2 + 1);
+            tree.erase(key * 2 + 1);
+        } else {
+            benchmark::DoNotOptimize(tree.contains(key * 2));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// каждый поток вставляет и удаляет нечетные ключи в своем диапазоне: непересекающиеся обновления
+template<typename Shared>
+void BM_SharedUpdate(benchmark::State& state) {
+    Shared& tree = SharedTree<Shared>();
+    std::vector<int> queries = MakeKeys(Uniform{}, kSharedSize, 7 + state.thread_index());
+    int range = static_cast<int>(2 * kSharedSize / state.threads());
+    int range_begin = range * state.thread_index();
+
+    size_t position = 0;
+    for (auto _: state) {
+        int key = range_begin + queries[position] % (range / 2) * 2 + 1;
+        position = position + 1 == queries.size() ? 0 : position + 1;
+        tree.insert(key);
+        tree.erase(key);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+#define THREADS ->ThreadRange(1, 32)->UseRealTime()
+
+BENCHMARK_TEMPLATE(BM_SharedFind, LockedTree, false) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedFind, Concurrent, false) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedFind, Sharded, false) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedFind, LockedTree, true) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedFind, Concurrent, true) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedFind, Sharded, true) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedUpdate, LockedTree) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedUpdate, Concurrent) THREADS;
+BENCHMARK_TEMPLATE(BM_SharedUpdate, Sharded) THREADS;
@@ -0,0 +1,66 @@
+#include <lib/bst.cpp>
+#include <benchmark/benchmark.h>
+
+#include "workloads.h"
+
+template<typename Balancing>
+using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, Balancing>;
+
+template<typename Balancing, typename Distribution>
+void BM_Insert(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Distribution{}, state.range(0));
+    for (auto _: state) {
+        Tree<Balancing> tree;
+        for (int key: keys) {
+            tree.insert(key);
+        }
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template<typename Balancing, typename Distribution>
+void BM_Find(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    Tree<Balancing> tree(keys.begin(), keys.end());
+    std::vector<int> queries = MakeKeys(Distribution{}, state.range(0), 7);
+
+    for (auto _: state) {
+        for (int key: queries) {
+            benchmark::DoNotOptimize(tree.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template<typename Balancing>
+void BM_InsertEraseMix(benchmark::State& state) {
+    std::vector<int> keys = MakeKeys(Uniform{}, state.range(0));
+    std::vector<int> operations = MakeKeys(Uniform{}, state.range(0), 7);
+    Tree<Balancing> tree(keys.begin(), keys.begin() + keys.size() / 2);
+
+    for (auto _: state) {
+        for (int key: operations) {
+            if (key & 1) {
+                tree.insert(key);
+            } else {
+                tree.erase(key - 1);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * operations.size());
+}
+
+#define POLICY_BENCHMARKS(Balancing)                                                      \
+    BENCHMARK_TEMPLATE(BM_Insert, Balancing, Sequential)->Arg(1 << 16);                   \
+    BENCHMARK_TEMPLATE(BM_Insert, Balancing, Uniform)->Arg(1 << 16);                      \
+    BENCHMARK_TEMPLATE(BM_Find, Balancing, Sequential)->Arg(1 << 16);                     \
+    BENCHMARK_TEMPLATE(BM_Find, Balancing, Uniform)->Arg(1 << 16);                        \
+    BENCHMARK_TEMPLATE(BM_Find, Balancing, Zipfian)->Arg(1 << 16);                        \
+    BENCHMARK_TEMPLATE(BM_InsertEraseMix, Balancing)->Arg(1 << 16);
+
+POLICY_BENCHMARKS(RedBlack)
+POLICY_BENCHMARKS(AVL)
+POLICY_BENCHMARKS(Treap)
+POLICY_BENCHMARKS(Splay)
+POLICY_BENCHMARKS(Scapegoat)
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+struct Sequential {};
+struct Uniform {};
+struct Zipfian {};
+struct Midpoint {};
+
+inline std::vector<int> MakeKeys(Sequential, size_t count, uint32_t = 0) {
+    std::vector<int> keys(count);
+    std::iota(keys.begin(), keys.end(), 0);
+    return keys;
+}
+
+inline std::vector<int> MakeKeys(Uniform, size_t count, uint32_t seed = 42) {
+    std::vector<int> keys = MakeKeys(Sequential{}, count);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+    return keys;
+}
+
+// ключи из [0, count), ранг r выпадает с вероятностью ~ 1 / r^0.99; горячие ключи разбросаны по всему диапазону
+inline std::vector<int> MakeKeys(Zipfian, size_t count, uint32_t seed = 42) {
+    std::vector<double> cdf(count);
+    double sum = 0;
+    for (size_t rank = 0; rank < count; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), 0.99);
+        cdf[rank] = sum;
+    }
+
+    std::vector<int> key_of_rank = MakeKeys(Uniform{}, count, seed + 1);
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(0, sum);
+
+    std::vector<int> keys(count);
+    for (int& key: keys) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), distribution(generator)) - cdf.begin();
+        key = key_of_rank[std::min(rank, count - 1)];
+    }
+    return keys;
+}
+
+// порядок вставки из FillSmartly: середина отрезка, затем правая и левая половины
+inline void AppendMidpoints(std::vector<int>& keys, int left, int right) {
+    if (left >= right) {
+        return;
+    }
+    int mid = left + (right - left) / 2;
+    keys.push_back(mid);
+    AppendMidpoints(keys, mid + 1, right);
+    AppendMidpoints(keys, left, mid);
+}
+
+inline std::vector<int> MakeKeys(Midpoint, size_t count, uint32_t = 0) {
+    std::vector<int> keys;
+    keys.reserve(count);
+    AppendMidpoints(keys, 0, static_cast<int>(count));
+    return keys;
+}
+
+inline size_t allocated_bytes = 0;
+
+// считает байты, живущие в контейнере, чтобы сравнивать накладные расходы на элемент
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        allocated_bytes += count * sizeof(T);
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        allocated_bytes -= count * sizeof(T);
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    bool operator==(const CountingAllocator&) const {
+        return true;
+    }
+};
@@ -1,758 +1,2394 @@
-#include <numeric>
-#include <functional>
-
-#include "bst.h"
-
-
-
-template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
-class BinarySearchTree {
-private:
-    struct BaseNode {
-        BaseNode* left = nullptr;
-        BaseNode* right = nullptr;
-        BaseNode* parent = nullptr;
-    };
-
-    struct Node: BaseNode {
-        Node(const Key key): key(key) {}
-
-        const Key key;
-    };
-
-    template<typename traversal_type = InOrder>
-    class Iterator {
-        friend BinarySearchTree;
-
-    public:
-        using pointer_type = const Key*;
-        using reference_type = const Key&;
-        using difference_type = size_t;
-        using value_type = Key;
-        using key_type = Key;
-
-    private:
-        BaseNode* node_;
-
-        Iterator(BaseNode* node): node_(node) {}
-
-    public:
-        Iterator(const Iterator<traversal_type>& other) {
-            node_ = other.node_;
-        }
-
-        Iterator& operator=(const Iterator<traversal_type>& other) {
-            node_ = other.node_;
-            return *this;
-        }
-
-        reference_type operator*() const {
-            return static_cast<Node*>(node_)->key;
-        }
-
-        pointer_type operator->() const {
-            return &static_cast<Node*>(node_)->key;
-        }
-
-
-        Iterator& operator++() {
-            Increment(traversal_type{});
-            return *this;
-        }
-
-
-        Iterator operator++(int) {
-            iterator<traversal_type> iterator_copy = *this;
-            ++(*this);
-            return iterator_copy;
-        }
-
-
-        Iterator& operator--() {
-            Decrement(traversal_type{});
-            return *this;
-        }
-
-
-        Iterator operator--(int)  {
-            iterator<traversal_type> iterator_copy = *this;
-            --(*this);
-            return iterator_copy;
-        }
-
-        bool operator==(const Iterator&) const = default;
-
-        bool operator!=(const Iterator&) const = default;
-
-    private:
-        void Increment(InOrder) {
-            if (node_->right) {
-                node_ = node_->right;
-                while (node_->left) {
-                    node_ = node_->left;
-                }
-            } else {
-                while (node_->parent->left != node_) {
-                    node_ = node_->parent;
-                }
-                node_ = node_->parent;
-            }
-        }
-
-        void Increment(PreOrder) {
-            if (node_->left) {
-                node_ = node_->left;
-                return;
-            }
-            if (node_->right) {
-                node_ = node_->right;
-                return;
-            }
-            while (!(node_->parent->left == node_ && node_->parent->right)) {
-                node_ = node_->parent;
-            }
-            node_ = node_->parent;
-
-            if (!IsFakeNode(node_)) {
-                node_ = node_->right;
-            }
-        }
-
-
-        void Increment(PostOrder) {
-            if (IsFakeNode(node_->parent) || node_->parent->right == node_) {
-                node_ = node_->parent;
-                return;
-            }
-
-            node_ = node_->parent;
-            if (!node_->right) {
-                return;
-            }
-            node_ = node_->right;
-            while (node_->left || node_->right) {
-                if (node_->left) {
-                    node_= node_->left;
-                } else {
-                    node_ = node_->right;
-                }
-            }
-        }
-
-        void Decrement(InOrder) {
-            if (node_->left) {
-                node_ = node_->left;
-                while (node_->right) {
-                    node_ = node_->right;
-                }
-            } else {
-                while (node_->parent->right != node_) {
-                    node_ = node_->parent;
-                }
-                node_ = node_->parent;
-            }
-        }
-
-        void Decrement(PreOrder) {
-            if (node_->parent->left == node_) {
-                node_ = node_->parent;
-                return;
-            }
-
-            if (!IsFakeNode(node_)) {
-                node_ = node_->parent;
-                if (!node_->left) {
-                    return;
-                }
-            }
-            node_ = node_->left;
-
-            while (node_->right || node_->left) {
-                if (node_->right) {
-                    node_ = node_->right;
-                } else {
-                    node_ = node_->left;
-                }
-            }
-        }
-
-        void Decrement(PostOrder)  {
-            if (IsFakeNode(node_)) {
-                node_ = node_->left;
-                return;
-            }
-            if (node_->right) {
-                node_ = node_->right;
-                return;
-            }
-            if (node_->left) {
-                node_ = node_->left;
-                return;
-            }
-
-            while (!(node_->parent->right == node_ && node_->parent->left)) {
-                node_ = node_->parent;
-            }
-            node_ = node_->parent->left;
-        }
-
-        bool IsFakeNode(const BaseNode* node) const {
-            return node->parent == node || (node->parent->left != node && node->parent->right != node);
-        }
-
-    };
-
-public:
-    using key_type = Key;
-    using value_type  = Key;
-    using reference = Key&;
-    using const_reference = const Key&;
-    using key_compare = Compare;
-    using value_compare = Compare;
-    using node_type = Node; // Or Node*
-
-    template<typename traversal_type>
-    using iterator = Iterator<traversal_type>;
-
-    template<typename traversal_type>
-    using const_iterator = Iterator<traversal_type>;
-
-    template<typename traversal_type>
-    using reverse_iterator = std::reverse_iterator<iterator<traversal_type>>;
-
-    template<typename traversal_type>
-    using const_reverse_iterator = std::reverse_iterator<const_iterator<traversal_type>>;
-
-    template<typename traversal_type>
-    using difference_type = std::iterator_traits<iterator<traversal_type>>::difference_type;
-
-    using size_type = size_t;
-
-    using AllocTraits = std::allocator_traits<typename std::allocator_traits<Allocator>::template rebind_alloc<Node>>;
-    std::allocator_traits<Allocator>::template rebind_alloc<Node> alloc_;
-
-
-    BinarySearchTree(key_compare comparator = Compare()): comparator_(comparator) {
-        SetDefaultFakeNodePointers();
-    }
-
-    template<typename Iter>
-    BinarySearchTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
-        SetDefaultFakeNodePointers();
-        while (iterator_start != iterator_finish) {
-            insert(*iterator_start);
-            ++iterator_start;
-        }
-    }
-
-    BinarySearchTree(std::initializer_list<value_type> initializer_list, Compare comparator = Compare()): comparator_(comparator) {
-        SetDefaultFakeNodePointers();
-        for (auto element: initializer_list) {
-            insert(element);
-        }
-    }
-
-    BinarySearchTree(const BinarySearchTree& other): alloc_(other.alloc_), comparator_(other.comparator_) {
-        SetDefaultFakeNodePointers();
-        for (auto element: other) {
-            insert(element);
-        }
-    }
-
-    ~BinarySearchTree() {
-        clear();
-    }
-
-
-    BinarySearchTree& operator=(const BinarySearchTree& other)  {
-        if (*this == other) {
-            return *this;
-        }
-        clear();
-        SetDefaultFakeNodePointers();
-        for (auto element: other) {
-            insert(element);
-        }
-        return *this;
-    }
-
-    BinarySearchTree& operator=(const std::initializer_list<value_type>& initializer_list) {
-        clear();
-        SetDefaultFakeNodePointers();
-        for (auto element: initializer_list) {
-            insert(element);
-        }
-        return *this;
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> begin() const {
-        return cbegin<traversal_type>();
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> end() const {
-        return cend<traversal_type>();
-    }
-
-    template<typename traversal_type = InOrder>
-    const_iterator<traversal_type> cbegin() const {
-        return cbegin(traversal_type{});
-    }
-
-
-    template<typename traversal_type = InOrder>
-    const_iterator<traversal_type> cend() const {
-        return iterator<traversal_type>(const_cast<BaseNode*>(&fake_node_));
-    }
-
-
-    template<typename traversal_type = InOrder>
-    reverse_iterator<traversal_type> rbegin() const {
-        return rcbegin<traversal_type>();
-    }
-
-
-    template<typename traversal_type = InOrder>
-    reverse_iterator<traversal_type> rend() const {
-        return rcend<traversal_type>();
-    }
-
-
-    template<typename traversal_type = InOrder>
-    const_reverse_iterator<traversal_type> rcbegin() const {
-        return reverse_iterator<traversal_type>(end<traversal_type>());
-    }
-
-
-    template<typename traversal_type = InOrder>
-    const_reverse_iterator<traversal_type> rcend() const {
-        return reverse_iterator<traversal_type>(begin<traversal_type>());
-    }
-
-
-    size_type size() const {
-        return size_;
-    }
-
-    size_type max_size() const{
-        return std::numeric_limits<size_type>::max();
-    }
-
-    bool empty() const {
-        return size_ == 0;
-    }
-
-
-    Compare key_comp() const {
-        return comparator_;
-    }
-
-
-    Compare value_comp() const {
-        return comparator_;
-    }
-
-    template<typename traversal_type = InOrder>
-    std::pair<iterator<traversal_type>, bool> insert(const Key& key) {
-        Node* new_node = alloc_.allocate(1);
-        AllocTraits::construct(alloc_, new_node, key);
-
-        if (fake_node_.left == &fake_node_) {
-            ++size_;
-            fake_node_.left = new_node;
-            fake_node_.right = new_node;
-            fake_node_.parent = new_node;
-            fake_node_.left->parent = &fake_node_;
-            return std::make_pair(iterator<traversal_type>(new_node), true);
-        }
-
-        if (comparator_(key, *begin())) {
-            ++size_;
-            Node* smallest_node = static_cast<Node*>(begin().node_);
-            smallest_node->left = new_node;
-            new_node->parent = smallest_node;
-            fake_node_.right = new_node;
-            fake_node_.parent = new_node;
-            return std::make_pair(iterator<traversal_type>(new_node), true);
-        }
-
-        Node* current = static_cast<Node*>(fake_node_.left);
-        while (true) {
-            if (comparator_(key, current->key)) {
-                if (current->left) {
-                    current = static_cast<Node*>(current->left);
-                } else {
-                    current->left = new_node;
-                    break;
-                }
-            } else if (comparator_(current->key, key)) {
-                if (current->right) {
-                    current = static_cast<Node*>(current->right);
-                } else {
-                    current->right = new_node;
-                    break;
-                }
-            } else {
-                return std::make_pair(iterator<traversal_type>(current), false);
-            }
-        }
-
-        new_node->parent = current;
-        if (fake_node_.right == fake_node_.left || comparator_(new_node->key, static_cast<Node*>(fake_node_.right->parent)->key)) {
-            // новая нода лежит в правом поддереве бегина и может стать новой X
-            // новая нода ребенок постбегина либо она меньше чем постбегин
-            if (comparator_(new_node->key, static_cast<Node*>(fake_node_.parent)->key) || new_node->parent == fake_node_.parent) {
-                fake_node_.parent = new_node;
-            }
-        }
-
-        ++size_;
-        return std::make_pair( iterator<traversal_type>(new_node),true);
-    }
-
-    template<typename Iter>
-    void insert(Iter start_iterator, Iter finish_iterator) {
-        while (start_iterator != finish_iterator) {
-            insert(*start_iterator);
-            ++start_iterator;
-        }
-    }
-
-
-    void insert(std::initializer_list<value_type> initializer_list) {
-        insert(initializer_list.begin(), initializer_list.end());
-    }
-
-    size_type erase(const Key& key) {
-        Iterator target = find(key);
-        if (target == end()) {
-            return 0;
-        }
-
-        Delete(static_cast<Node*>(target.node_));
-        if (target.node_ == fake_node_.parent) {
-            SetPostOrderBegin();
-        }
-
-        return 1;
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> erase(const_iterator<traversal_type> iterator) {
-        auto next_iterator = upper_bound<traversal_type>(static_cast<Node*>(iterator.node_)->key);
-        Delete(static_cast<Node*>(iterator.node_));
-        if (iterator.node_ == fake_node_.parent) {
-            SetPostOrderBegin();
-        }
-
-        return next_iterator;
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> erase(iterator<traversal_type> iterator_start, iterator<traversal_type> iterator_finish)  {
-        while (iterator_start != iterator_finish) {
-            iterator_start = erase(iterator_start);
-        }
-        return iterator_finish;
-    }
-
-
-    void clear() {
-        erase(begin(), end());
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> find(const Key& key) const {
-        if (!size_) {
-            return end<traversal_type>();
-        }
-
-        Node* current = static_cast<Node*>(fake_node_.left);
-        while (true) {
-            if (comparator_(key, current->key)) {
-                if (current->left) {
-                    current = static_cast<Node*>(current->left);
-                } else {
-                    return end<traversal_type>();
-                }
-            } else if (comparator_(current->key, key)) {
-                if (current->right) {
-                    current = static_cast<Node*>(current->right);
-                } else {
-                    return end<traversal_type>();
-                }
-            } else {
-                return iterator<traversal_type>(current);
-            }
-        }
-
-    }
-
-    size_type count(const Key& key) const {
-        return find(key) == end() ? 0: 1;
-    }
-
-
-    bool contains(const Key& key) const {
-        return find(key) != end();
-    }
-
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> lower_bound(const Key& key) const {
-        if (!size_) {
-            return end<traversal_type>();
-        }
-
-        Node* current = static_cast<Node*>(fake_node_.left);
-        Node* best = nullptr;
-
-        while (current != nullptr) {
-            if (comparator_(current->key, key)) {
-                current = static_cast<Node*>(current->right);
-            } else {
-                if (best == nullptr || comparator_(current->key, best->key)) {
-                    best = current;
-                }
-                current = static_cast<Node*>(current->left);
-            }
-        }
-
-        return best ? iterator<traversal_type>(best): end<traversal_type>();
-    }
-
-    template<typename traversal_type = InOrder>
-    iterator<traversal_type> upper_bound(const Key& key) const {
-        if (!size_) {
-            return end<traversal_type>();
-        }
-
-        Node* current = static_cast<Node*>(fake_node_.left);
-        Node* best = nullptr;
-
-        while (current != nullptr) {
-            if (comparator_(current->key, key) || !comparator_(key, current->key)) {
-                current = static_cast<Node*>(current->right);
-            } else {
-                if (best == nullptr || comparator_(current->key, best->key)) {
-                    best = current;
-                }
-                current = static_cast<Node*>(current->left);
-            }
-        }
-
-        return best ? iterator<traversal_type>(best): end<traversal_type>();
-    }
-
-    template<typename traversal_type = InOrder>
-    std::pair<iterator<traversal_type>, iterator<traversal_type>> equal_range(const Key& key) const {
-        return std::make_pair(lower_bound<traversal_type>(key), upper_bound<traversal_type>(key));
-    }
-
-    void swap(BinarySearchTree& other) {
-        if (other.size_) {
-            other.fake_node_.left->parent = &fake_node_;
-        }
-        if (size_) {
-            fake_node_.left->parent = &(other.fake_node_);
-        }
-
-        std::swap(fake_node_, other.fake_node_);
-        std::swap(size_, other.size_);
-        std::swap(comparator_, other.comparator_);
-        std::swap(alloc_, other.alloc_);
-
-        if (!size_) {
-            fake_node_.left = &fake_node_;
-            fake_node_.right = fake_node_.left;
-            fake_node_.parent = fake_node_.left;
-        }
-        if (!other.size_) {
-            other.fake_node_.left = &other.fake_node_;
-            other.fake_node_.right = other.fake_node_.left;
-            other.fake_node_.parent = other.fake_node_.left;
-        }
-    }
-
-private:
-    void Delete(Node* node) {
-        --size_;
-
-        if (node == fake_node_.right) {
-            fake_node_.right = upper_bound(node->key).node_;
-        }
-
-        if (!node->left && !node->right) {
-            if ((!node->parent) || (node->parent == &fake_node_)) {
-                AllocTraits::destroy(alloc_, fake_node_.left);
-                alloc_.deallocate(static_cast<Node*>(fake_node_.left), 1);
-
-                fake_node_.left = &fake_node_;
-                fake_node_.right = &fake_node_;
-                return;
-            }
-            if (node->parent->left == node) {
-                node->parent->left = nullptr;
-            } else {
-                node->parent->right = nullptr;
-            }
-
-            AllocTraits::destroy(alloc_, node);
-            alloc_.deallocate(node, 1);
-
-            return;
-        }
-
-        if (!node->left) {
-            if (node == fake_node_.left) {
-                fake_node_.left = node->right;
-                node->right->parent = &fake_node_;
-                AllocTraits::destroy(alloc_, node);
-                alloc_.deallocate(node, 1);
-                return;
-            }
-
-            node->right->parent = node->parent;
-            if (node->parent->left == node) {
-                node->parent->left = node->right;
-            } else {
-                node->parent->right = node->right;
-            }
-            AllocTraits::destroy(alloc_, node);
-            alloc_.deallocate(node, 1);
-            return;
-        }
-
-        if (!node->right) {
-            if (node == fake_node_.parent) {
-                fake_node_.left = node->left;
-                node->left->parent = &fake_node_;
-                AllocTraits::destroy(alloc_, node);
-                alloc_.deallocate(node, 1);
-                return;
-            }
-
-            node->left->parent = node->parent;
-            if (node->parent->left == node) {
-                node->parent->left = node->left;
-            } else {
-                node->parent->right = node->left;
-            }
-            AllocTraits::destroy(alloc_, node);
-            alloc_.deallocate(node, 1);
-            return;
-        }
-
-        Node* node_to_swap_with = static_cast<Node*>(upper_bound(node->key).node_);
-
-        if (node_to_swap_with->parent->left == node_to_swap_with) {
-            node_to_swap_with->parent->left = node_to_swap_with->right;
-        } else {
-            node_to_swap_with->parent->right = node_to_swap_with->right;
-        }
-        if (node_to_swap_with->right) {
-            node_to_swap_with->right->parent = node_to_swap_with->parent;
-        }
-
-        node_to_swap_with->parent = node->parent;
-        if (node->right != node_to_swap_with) {
-            node_to_swap_with->right = node->right;
-        } else {
-            node_to_swap_with->right = nullptr;
-        }
-        node_to_swap_with->left = node->left;
-
-        if (node_to_swap_with->right) {
-            node_to_swap_with->right->parent = node_to_swap_with;
-        }
-        node_to_swap_with->left->parent = node_to_swap_with;
-        if (node->parent->left == node) {
-            node->parent->left = node_to_swap_with;
-        } else {
-            node->parent->right = node_to_swap_with;
-        }
-
-        AllocTraits::destroy(alloc_, node);
-        alloc_.deallocate(node, 1);
-    }
-
-    void SetPostOrderBegin() {
-        if (empty()) {
-            SetDefaultFakeNodePointers();
-            return;
-        }
-        BaseNode* current = fake_node_.right;
-        while (current->left || current->right) {
-            if (current->left) {
-                current = current->left;
-            } else {
-                current = current->right;
-            }
-        }
-        fake_node_.parent = current;
-    }
-
-    void SetDefaultFakeNodePointers() {
-        fake_node_.left = &fake_node_;
-        fake_node_.right = fake_node_.left;
-        fake_node_.parent = fake_node_.left;
-    }
-
-    const_iterator<InOrder> cbegin(InOrder) const {
-        return iterator<InOrder>(fake_node_.right);
-    }
-
-
-    const_iterator<PreOrder> cbegin(PreOrder) const {
-        return iterator<PreOrder>(fake_node_.left);
-    }
-
-    const_iterator<PostOrder> cbegin(PostOrder) const {
-        return iterator<PostOrder>(fake_node_.parent);
-    }
-
-
-    BaseNode fake_node_;
-    size_type size_ = 0;
-
-    Compare comparator_;
-};
-
-
-
-template<typename Key, typename Compare, typename Allocator>
-void swap(BinarySearchTree<Key, Compare, Allocator>& first, BinarySearchTree<Key, Compare, Allocator>& second) {
-    first.swap(second);
-}
-
-template<typename  Key, typename Compare, typename Allocator>
-bool operator==(const BinarySearchTree<Key, Compare, Allocator>& first, const BinarySearchTree<Key, Compare, Allocator>& second) {
-    if (first.size() != second.size()) {
-        return false;
-    }
-    auto iterator_first = first.begin();
-    auto iterator_second = second.begin();
-
-    while (iterator_first != first.end()) {
-        if (*iterator_first != *iterator_second) {
-            std::cout << *iterator_first << ' ' << *iterator_second << '\n';
-            return false;
-        }
-        ++iterator_first;
-        ++iterator_second;
-    }
-
-    return true;
-}
-
-template<typename  Key, typename Compare, typename Allocator>
-bool operator!=(const BinarySearchTree<Key, Compare, Allocator>& first, const BinarySearchTree<Key, Compare, Allocator>& second) {
-    return !(first == second);
-}
-
-
-
-
-
-
+#pragma once
+
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <bit>
+#include <optional>
+
+#include "bst.h"
+#include "frozen.cpp"
+#include "static_btree.cpp"
+#include "work_stealing_pool.cpp"
+
+
+
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>, typename balancing_type = RedBlack, typename augmentation_type = NoAugmentation, typename stats_type = NoStats>
+class BinarySearchTree {
+private:
+    struct BaseNode {
+        BaseNode* left = nullptr;
+        BaseNode* right = nullptr;
+        BaseNode* parent = nullptr;
+    };
+
+    static constexpr bool kSubtreeSizes = std::is_same_v<augmentation_type, OrderStatistics>;
+    static constexpr bool kStats = std::is_same_v<stats_type, CollectStats>;
+    // столько поисков find_many ведет одновременно - порядка числа промахов L1, обслуживаемых процессором параллельно
+    static constexpr size_t kSearchGroup = 16;
+    // меньшие деревья обходятся в вызывающем потоке; на каждый поток пула нарезается порядка kTasksPerThread
+    // поддеревьев, чтобы воркеры, закончившие раньше, было что красть
+    static constexpr size_t kParallelGrain = 1 << 14;
+    static constexpr size_t kTasksPerThread = 8;
+
+    struct Node: BaseNode, BalanceData<balancing_type>, AugmentData<augmentation_type> {
+        template<typename... Args>
+        Node(Args&&... args): key(std::forward<Args>(args)...) {}
+
+        const Key key;
+    };
+
+    template<typename traversal_type = InOrder>
+    class Iterator {
+        friend BinarySearchTree;
+
+        static constexpr bool kRandomAccess = kSubtreeSizes && std::is_same_v<traversal_type, InOrder>;
+
+    public:
+        using pointer_type = const Key*;
+        using reference_type = const Key&;
+        using pointer = const Key*;
+        using reference = const Key&;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Key;
+        using key_type = Key;
+        using iterator_category = std::conditional_t<kRandomAccess, std::random_access_iterator_tag, std::bidirectional_iterator_tag>;
+
+    private:
+        BaseNode* node_;
+
+        Iterator(BaseNode* node): node_(node) {}
+
+    public:
+        Iterator(): node_(nullptr) {}
+
+        Iterator(const Iterator<traversal_type>& other) {
+            node_ = other.node_;
+        }
+
+        Iterator& operator=(const Iterator<traversal_type>& other) {
+            node_ = other.node_;
+            return *this;
+        }
+
+        reference_type operator*() const {
+            return static_cast<Node*>(node_)->key;
+        }
+
+        pointer_type operator->() const {
+            return &static_cast<Node*>(node_)->key;
+        }
+
+
+        Iterator& operator++() {
+            Increment(traversal_type{});
+            return *this;
+        }
+
+
+        Iterator operator++(int) {
+            iterator<traversal_type> iterator_copy = *this;
+            ++(*this);
+            return iterator_copy;
+        }
+
+
+        Iterator& operator--() {
+            Decrement(traversal_type{});
+            return *this;
+        }
+
+
+        Iterator operator--(int)  {
+            iterator<traversal_type> iterator_copy = *this;
+            --(*this);
+            return iterator_copy;
+        }
+
+        bool operator==(const Iterator&) const = default;
+
+        bool operator!=(const Iterator&) const = default;
+
+        // при хранении размеров поддеревьев in-order итератор прыгает на n позиций за O(log n)
+        Iterator& operator+=(difference_type offset) requires kRandomAccess {
+            node_ = SelectNode(FakeNodeOf(node_), Rank(node_) + offset);
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type offset) requires kRandomAccess {
+            return *this += -offset;
+        }
+
+        Iterator operator+(difference_type offset) const requires kRandomAccess {
+            Iterator result = *this;
+            return result += offset;
+        }
+
+        friend Iterator operator+(difference_type offset, const Iterator& iterator) requires kRandomAccess {
+            return iterator + offset;
+        }
+
+        Iterator operator-(difference_type offset) const requires kRandomAccess {
+            Iterator result = *this;
+            return result -= offset;
+        }
+
+        difference_type operator-(const Iterator& other) const requires kRandomAccess {
+            return static_cast<difference_type>(Rank(node_)) - static_cast<difference_type>(Rank(other.node_));
+        }
+
+        reference_type operator[](difference_type offset) const requires kRandomAccess {
+            return *(*this + offset);
+        }
+
+        bool operator<(const Iterator& other) const requires kRandomAccess {
+            return Rank(node_) < Rank(other.node_);
+        }
+
+        bool operator>(const Iterator& other) const requires kRandomAccess {
+            return other < *this;
+        }
+
+        bool operator<=(const Iterator& other) const requires kRandomAccess {
+            return !(other < *this);
+        }
+
+        bool operator>=(const Iterator& other) const requires kRandomAccess {
+            return !(*this < other);
+        }
+
+    private:
+        void Increment(InOrder) {
+            if (node_->right) {
+                node_ = node_->right;
+                while (node_->left) {
+                    node_ = node_->left;
+                }
+            } else {
+                while (node_->parent->left != node_) {
+                    node_ = node_->parent;
+                }
+                node_ = node_->parent;
+            }
+        }
+
+        void Increment(PreOrder) {
+            if (node_->left) {
+                node_ = node_->left;
+                return;
+            }
+            if (node_->right) {
+                node_ = node_->right;
+                return;
+            }
+            while (!(node_->parent->left == node_ && node_->parent->right)) {
+                node_ = node_->parent;
+            }
+            node_ = node_->parent;
+
+            if (!IsFakeNode(node_)) {
+                node_ = node_->right;
+            }
+        }
+
+
+        void Increment(PostOrder) {
+            if (IsFakeNode(node_->parent) || node_->parent->right == node_) {
+                node_ = node_->parent;
+                return;
+            }
+
+            node_ = node_->parent;
+            if (!node_->right) {
+                return;
+            }
+            node_ = node_->right;
+            while (node_->left || node_->right) {
+                if (node_->left) {
+                    node_= node_->left;
+                } else {
+                    node_ = node_->right;
+                }
+            }
+        }
+
+        void Decrement(InOrder) {
+            if (node_->left) {
+                node_ = node_->left;
+                while (node_->right) {
+                    node_ = node_->right;
+                }
+            } else {
+                while (node_->parent->right != node_) {
+                    node_ = node_->parent;
+                }
+                node_ = node_->parent;
+            }
+        }
+
+        void Decrement(PreOrder) {
+            if (node_->parent->left == node_) {
+                node_ = node_->parent;
+                return;
+            }
+
+            if (!IsFakeNode(node_)) {
+                node_ = node_->parent;
+                if (!node_->left) {
+                    return;
+                }
+            }
+            node_ = node_->left;
+
+            while (node_->right || node_->left) {
+                if (node_->right) {
+                    node_ = node_->right;
+                } else {
+                    node_ = node_->left;
+                }
+            }
+        }
+
+        void Decrement(PostOrder)  {
+            if (IsFakeNode(node_)) {
+                node_ = node_->left;
+                return;
+            }
+            if (node_->right) {
+                node_ = node_->right;
+                return;
+            }
+            if (node_->left) {
+                node_ = node_->left;
+                return;
+            }
+
+            while (!(node_->parent->right == node_ && node_->parent->left)) {
+                node_ = node_->parent;
+            }
+            node_ = node_->parent->left;
+        }
+
+        static bool IsFakeNode(const BaseNode* node) {
+            return node->parent == node || (node->parent->left != node && node->parent->right != node);
+        }
+
+        static BaseNode* FakeNodeOf(BaseNode* node) {
+            while (!IsFakeNode(node)) {
+                node = node->parent;
+            }
+            return node;
+        }
+
+        // число ключей левее node; для end() - размер дерева
+        static size_t Rank(const BaseNode* node) {
+            if (IsFakeNode(node)) {
+                return node->left == node ? 0 : SubtreeSize(node->left);
+            }
+            size_t rank = SubtreeSize(node->left);
+            for (; !IsFakeNode(node->parent); node = node->parent) {
+                if (node->parent->right == node) {
+                    rank += SubtreeSize(node->parent->left) + 1;
+                }
+            }
+            return rank;
+        }
+
+    };
+
+    // помнит последнюю найденную ноду; поиск поднимается от нее по parent только до поддерева, содержащего ключ,
+    // поэтому для близких ключей стоимость зависит от расстояния между ними, а не от высоты дерева.
+    // Как и итераторы, инвалидируется удалением своей ноды
+    class Cursor {
+        friend BinarySearchTree;
+
+    public:
+        Iterator<InOrder> lower_bound(const Key& key) {
+            BaseNode* result = tree_->FingerLowerBound(node_, key);
+            Move(result);
+            return Iterator<InOrder>(result);
+        }
+
+        Iterator<InOrder> find(const Key& key) {
+            BaseNode* result = tree_->FingerLowerBound(node_, key);
+            Move(result);
+            if (result == &tree_->fake_node_ || tree_->Less(key, static_cast<Node*>(result)->key)) {
+                return tree_->end();
+            }
+            return Iterator<InOrder>(result);
+        }
+
+        bool contains(const Key& key) {
+            return find(key) != tree_->end();
+        }
+
+        Iterator<InOrder> position() const {
+            return Iterator<InOrder>(node_ ? node_ : &tree_->fake_node_);
+        }
+
+    private:
+        Cursor(const BinarySearchTree* tree, BaseNode* node): tree_(tree), node_(node) {}
+
+        // промах за максимумом оставляет курсор на прежнем месте
+        void Move(BaseNode* result) {
+            if (result != &tree_->fake_node_) {
+                tree_->AfterAccess(static_cast<Node*>(result), balancing_type{});
+                node_ = result;
+            }
+        }
+
+        const BinarySearchTree* tree_;
+        BaseNode* node_;
+    };
+
+public:
+    using key_type = Key;
+    using value_type  = Key;
+    using reference = Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using node_type = Node; // Or Node*
+
+    template<typename traversal_type>
+    using iterator = Iterator<traversal_type>;
+
+    template<typename traversal_type>
+    using const_iterator = Iterator<traversal_type>;
+
+    template<typename traversal_type>
+    using reverse_iterator = std::reverse_iterator<iterator<traversal_type>>;
+
+    template<typename traversal_type>
+    using const_reverse_iterator = std::reverse_iterator<const_iterator<traversal_type>>;
+
+    template<typename traversal_type>
+    using difference_type = std::iterator_traits<iterator<traversal_type>>::difference_type;
+
+    using size_type = size_t;
+
+    using AllocTraits = std::allocator_traits<typename std::allocator_traits<Allocator>::template rebind_alloc<Node>>;
+    std::allocator_traits<Allocator>::template rebind_alloc<Node> alloc_;
+
+
+    BinarySearchTree(key_compare comparator = Compare()): comparator_(comparator) {
+        SetDefaultFakeNodePointers();
+    }
+
+    template<typename Iter>
+    BinarySearchTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        SetDefaultFakeNodePointers();
+        if constexpr (std::forward_iterator<Iter>) {
+            if (std::is_sorted(iterator_start, iterator_finish, [this](const Key& first, const Key& second) { return Less(first, second); })) {
+                BuildFromSorted(iterator_start, iterator_finish);
+                return;
+            }
+        }
+        while (iterator_start != iterator_finish) {
+            insert(*iterator_start);
+            ++iterator_start;
+        }
+    }
+
+    // диапазон должен быть отсортирован по comparator; подряд идущие эквивалентные ключи схлопываются
+    template<typename Iter>
+    BinarySearchTree(AssumeSorted, Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        SetDefaultFakeNodePointers();
+        BuildFromSorted(iterator_start, iterator_finish);
+    }
+
+    template<typename Iter>
+    static BinarySearchTree from_sorted(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()) {
+        return BinarySearchTree(assume_sorted, iterator_start, iterator_finish, comparator);
+    }
+
+    BinarySearchTree(std::initializer_list<value_type> initializer_list, Compare comparator = Compare()): comparator_(comparator) {
+        SetDefaultFakeNodePointers();
+        for (auto element: initializer_list) {
+            insert(element);
+        }
+    }
+
+    BinarySearchTree(const BinarySearchTree& other): alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)), comparator_(other.comparator_) {
+        SetDefaultFakeNodePointers();
+        CloneFrom(other);
+    }
+
+    BinarySearchTree(BinarySearchTree&& other) noexcept: alloc_(std::move(other.alloc_)), comparator_(other.comparator_) {
+        SetDefaultFakeNodePointers();
+        StealFrom(other);
+    }
+
+    ~BinarySearchTree() {
+        clear();
+    }
+
+
+    BinarySearchTree& operator=(const BinarySearchTree& other)  {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        comparator_ = other.comparator_;
+        CloneFrom(other);
+        return *this;
+    }
+
+    BinarySearchTree& operator=(BinarySearchTree&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        comparator_ = other.comparator_;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            alloc_ = std::move(other.alloc_);
+        } else if (!AllocTraits::is_always_equal::value && alloc_ != other.alloc_) {
+            // чужие ноды нельзя вернуть нашим аллокатором, остается только копирование
+            CloneFrom(other);
+            return *this;
+        }
+        StealFrom(other);
+        return *this;
+    }
+
+    BinarySearchTree& operator=(const std::initializer_list<value_type>& initializer_list) {
+        clear();
+        SetDefaultFakeNodePointers();
+        for (auto element: initializer_list) {
+            insert(element);
+        }
+        return *this;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> begin() const {
+        return cbegin<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> end() const {
+        return cend<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cbegin() const {
+        return cbegin(traversal_type{});
+    }
+
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cend() const {
+        return iterator<traversal_type>(const_cast<BaseNode*>(&fake_node_));
+    }
+
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rbegin() const {
+        return rcbegin<traversal_type>();
+    }
+
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rend() const {
+        return rcend<traversal_type>();
+    }
+
+
+    template<typename traversal_type = InOrder>
+    const_reverse_iterator<traversal_type> rcbegin() const {
+        return reverse_iterator<traversal_type>(end<traversal_type>());
+    }
+
+
+    template<typename traversal_type = InOrder>
+    const_reverse_iterator<traversal_type> rcend() const {
+        return reverse_iterator<traversal_type>(begin<traversal_type>());
+    }
+
+
+    size_type size() const {
+        return size_;
+    }
+
+    size_type max_size() const{
+        return std::numeric_limits<size_type>::max();
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+
+    Compare value_comp() const {
+        return comparator_;
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(const Key& key) {
+        return InsertUnique<traversal_type>(key, key);
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(Key&& key) {
+        return InsertUnique<traversal_type>(key, std::move(key));
+    }
+
+    template<typename traversal_type = InOrder, typename... Args>
+    std::pair<iterator<traversal_type>, bool> emplace(Args&&... args) {
+        if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, Key> && ...)) {
+            return InsertUnique<traversal_type>(args..., std::forward<Args>(args)...);
+        } else {
+            Key key(std::forward<Args>(args)...);
+            return InsertUnique<traversal_type>(key, std::move(key));
+        }
+    }
+
+    // ищет по key и только при его отсутствии строит ключ ноды из args; построенный ключ должен быть эквивалентен key
+    template<typename traversal_type = InOrder, typename... Args>
+    std::pair<iterator<traversal_type>, bool> try_emplace(const Key& key, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            return InsertUnique<traversal_type>(key, key);
+        } else {
+            return InsertUnique<traversal_type>(key, std::forward<Args>(args)...);
+        }
+    }
+
+    // если key встает между hint и его in-order предшественником, нода подвешивается без спуска от корня;
+    // иначе обычная вставка. insert(end(), key) для растущего потока ключей работает за O(1)
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> insert(const_iterator<traversal_type> hint, const Key& key) {
+        return InsertHinted<traversal_type>(hint.node_, key, key);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> insert(const_iterator<traversal_type> hint, Key&& key) {
+        return InsertHinted<traversal_type>(hint.node_, key, std::move(key));
+    }
+
+    template<typename traversal_type = InOrder, typename... Args>
+    iterator<traversal_type> emplace_hint(const_iterator<traversal_type> hint, Args&&... args) {
+        if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, Key> && ...)) {
+            return InsertHinted<traversal_type>(hint.node_, args..., std::forward<Args>(args)...);
+        } else {
+            Key key(std::forward<Args>(args)...);
+            return InsertHinted<traversal_type>(hint.node_, key, std::move(key));
+        }
+    }
+
+    template<typename Iter>
+    void insert(Iter start_iterator, Iter finish_iterator) {
+        while (start_iterator != finish_iterator) {
+            insert(*start_iterator);
+            ++start_iterator;
+        }
+    }
+
+
+    void insert(std::initializer_list<value_type> initializer_list) {
+        insert(initializer_list.begin(), initializer_list.end());
+    }
+
+    size_type erase(const Key& key) {
+        Iterator target = find(key);
+        if (target == end()) {
+            return 0;
+        }
+
+        Delete(static_cast<Node*>(target.node_));
+        return 1;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(const_iterator<traversal_type> position) {
+        BaseNode* next = InOrderNext(position.node_);
+        Delete(static_cast<Node*>(position.node_));
+        return iterator<traversal_type>(next);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(iterator<traversal_type> iterator_start, iterator<traversal_type> iterator_finish)  {
+        if (iterator_start == begin<traversal_type>() && iterator_finish == end<traversal_type>()) {
+            clear();
+            return end<traversal_type>();
+        }
+        while (iterator_start != iterator_finish) {
+            iterator_start = erase(iterator_start);
+        }
+        return iterator_finish;
+    }
+
+
+    void clear() {
+        if constexpr (requires { alloc_.release(); }) {
+            if (std::is_trivially_destructible_v<Node> && alloc_.release()) {
+                if constexpr (kStats) {
+                    stats_.deallocations += size_;
+                }
+                size_ = 0;
+                balance_state_ = {};
+                SetDefaultFakeNodePointers();
+                return;
+            }
+        }
+
+        // обход в post-order: следующая нода вычисляется до освобождения текущей, а ее предки еще живы
+        BaseNode* node = empty() ? &fake_node_ : fake_node_.parent;
+        while (node != &fake_node_) {
+            BaseNode* parent = node->parent;
+            BaseNode* next = parent;
+            if (parent != &fake_node_ && parent->left == node && parent->right) {
+                next = FirstLeaf(parent->right);
+            }
+            AllocTraits::destroy(alloc_, static_cast<Node*>(node));
+            DeallocateNode(static_cast<Node*>(node));
+            node = next;
+        }
+
+        size_ = 0;
+        balance_state_ = {};
+        SetDefaultFakeNodePointers();
+    }
+
+    // поддеревья освобождаются параллельно, каждое в post-order. Потокобезопасность гарантирована только
+    // у std::allocator, а счетчики статистики не атомарны - в остальных случаях это обычный clear
+    void clear(WorkStealingPool& pool) {
+        if constexpr (!std::is_same_v<Allocator, std::allocator<Key>> || kStats) {
+            clear();
+        } else {
+            if (size_ < kParallelGrain) {
+                clear();
+                return;
+            }
+            BaseNode* root = fake_node_.left;
+            pool.run([&] { DestroyParallel(root, pool, SplitDepth(pool)); });
+
+            size_ = 0;
+            balance_state_ = {};
+            SetDefaultFakeNodePointers();
+        }
+    }
+
+    // дерево делится на задачи по корням поддеревьев. function вызывается из разных потоков одновременно
+    // и в произвольном порядке; дерево на время обхода менять нельзя
+    template<typename Function>
+    void parallel_for_each(Function function, WorkStealingPool& pool = WorkStealingPool::global()) const {
+        if (size_ < kParallelGrain) {
+            VisitInOrder(size_ ? fake_node_.left : nullptr, [&](const BaseNode* node) { function(KeyOf(node)); });
+            return;
+        }
+        pool.run([&] { ForEachParallel(fake_node_.left, function, pool, SplitDepth(pool)); });
+    }
+
+    // reduce(init, transform(k1), ..., transform(kn)) в in-order порядке ключей. reduce должна быть ассоциативной,
+    // коммутативность не нужна: частичные результаты поддеревьев склеиваются слева направо
+    template<typename T, typename Reduce, typename Transform = std::identity>
+    T parallel_reduce(T init, Reduce reduce, Transform transform = {}, WorkStealingPool& pool = WorkStealingPool::global()) const {
+        if (size_ == 0) {
+            return init;
+        }
+        std::optional<T> result;
+        if (size_ < kParallelGrain) {
+            result.emplace(FoldSequential<T>(fake_node_.left, reduce, transform));
+        } else {
+            pool.run([&] { result.emplace(FoldParallel<T>(fake_node_.left, reduce, transform, pool, SplitDepth(pool))); });
+        }
+        return reduce(std::move(init), std::move(*result));
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> find(const Key& key) const {
+        Node* current = size_ ? static_cast<Node*>(fake_node_.left) : nullptr;
+        size_type visited = 0;
+        while (current) {
+            ++visited;
+            if (Less(key, current->key)) {
+                current = static_cast<Node*>(current->left);
+            } else if (Less(current->key, key)) {
+                current = static_cast<Node*>(current->right);
+            } else {
+                break;
+            }
+        }
+        RecordDescent(&TreeStats::find, visited);
+
+        if (!current) {
+            return end<traversal_type>();
+        }
+        AfterAccess(current, balancing_type{});
+        return iterator<traversal_type>(current);
+    }
+
+    size_type count(const Key& key) const {
+        return find(key) == end() ? 0: 1;
+    }
+
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> lower_bound(const Key& key) const {
+        if (!size_) {
+            return end<traversal_type>();
+        }
+
+        Node* current = static_cast<Node*>(fake_node_.left);
+        Node* best = nullptr;
+        size_type visited = 0;
+
+        while (current != nullptr) {
+            ++visited;
+            if (Less(current->key, key)) {
+                current = static_cast<Node*>(current->right);
+            } else {
+                if (best == nullptr || Less(current->key, best->key)) {
+                    best = current;
+                }
+                current = static_cast<Node*>(current->left);
+            }
+        }
+        RecordDescent(&TreeStats::lower_bound, visited);
+
+        if (!best) {
+            return end<traversal_type>();
+        }
+        AfterAccess(best, balancing_type{});
+        return iterator<traversal_type>(best);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> upper_bound(const Key& key) const {
+        if (!size_) {
+            return end<traversal_type>();
+        }
+
+        Node* current = static_cast<Node*>(fake_node_.left);
+        Node* best = nullptr;
+        size_type visited = 0;
+
+        while (current != nullptr) {
+            ++visited;
+            if (Less(current->key, key) || !Less(key, current->key)) {
+                current = static_cast<Node*>(current->right);
+            } else {
+                if (best == nullptr || Less(current->key, best->key)) {
+                    best = current;
+                }
+                current = static_cast<Node*>(current->left);
+            }
+        }
+        RecordDescent(&TreeStats::upper_bound, visited);
+
+        if (!best) {
+            return end<traversal_type>();
+        }
+        AfterAccess(best, balancing_type{});
+        return iterator<traversal_type>(best);
+    }
+
+    // result[i] - итератор на keys[i] или end(); result должен быть не короче keys
+    template<typename traversal_type = InOrder>
+    void find_many(std::span<const Key> keys, std::span<iterator<traversal_type>> result) const {
+        DescendMany<false>(keys, &TreeStats::find, [&](size_t index, Node* node) {
+            result[index] = node ? iterator<traversal_type>(node) : end<traversal_type>();
+        });
+    }
+
+    template<typename traversal_type = InOrder>
+    void lower_bound_many(std::span<const Key> keys, std::span<iterator<traversal_type>> result) const {
+        DescendMany<true>(keys, &TreeStats::lower_bound, [&](size_t index, Node* node) {
+            result[index] = node ? iterator<traversal_type>(node) : end<traversal_type>();
+        });
+    }
+
+    void contains_many(std::span<const Key> keys, std::span<bool> result) const {
+        DescendMany<false>(keys, &TreeStats::find, [&](size_t index, Node* node) {
+            result[index] = node != nullptr;
+        });
+    }
+
+    // курсор для серии поисков близких ключей; без аргумента первый поиск идет от корня
+    Cursor cursor() const {
+        return Cursor(this, nullptr);
+    }
+
+    Cursor cursor(const_iterator<InOrder> position) const {
+        return Cursor(this, position.node_ == &fake_node_ ? nullptr : position.node_);
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, iterator<traversal_type>> equal_range(const Key& key) const {
+        return std::make_pair(lower_bound<traversal_type>(key), upper_bound<traversal_type>(key));
+    }
+
+    // число ключей, меньших key
+    size_type rank(const Key& key) const requires kSubtreeSizes {
+        size_type result = 0;
+        const BaseNode* current = size_ ? fake_node_.left : nullptr;
+        while (current) {
+            if (Less(static_cast<const Node*>(current)->key, key)) {
+                result += SubtreeSize(current->left) + 1;
+                current = current->right;
+            } else {
+                current = current->left;
+            }
+        }
+        return result;
+    }
+
+    // index-й по возрастанию ключ, считая с нуля; end() если index >= size()
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> select(size_type index) const requires kSubtreeSizes {
+        return iterator<traversal_type>(SelectNode(const_cast<BaseNode*>(&fake_node_), index));
+    }
+
+    // число ключей в полуинтервале [lower, upper)
+    size_type count_range(const Key& lower, const Key& upper) const requires kSubtreeSizes {
+        if (!Less(lower, upper)) {
+            return 0;
+        }
+        return rank(upper) - rank(lower);
+    }
+
+    // read-only снимок: для int, uint64_t и double с std::less - StaticBTree с SIMD-поиском, иначе раскладка Эйтцингера;
+    // последующие изменения дерева на него не влияют
+    FrozenIndex<Key, Compare, Allocator> freeze() const {
+        return FrozenIndex<Key, Compare, Allocator>(assume_sorted, begin(), size_, comparator_, Allocator(alloc_));
+    }
+
+    // счетчики принадлежат объекту дерева: не копируются, не переезжают при move и swap
+    TreeStats stats() const requires kStats {
+        return stats_;
+    }
+
+    void reset_stats() requires kStats {
+        stats_ = {};
+    }
+
+    // ключи, не меньшие key, переезжают в возвращаемое дерево вместе с нодами. Если одна из частей мала
+    // (не больше n / log n ключей), она переносится по ноде за O(k log n); иначе split стоит O(n):
+    // обе половины пересобираются из списка
+    BinarySearchTree split(const Key& key) {
+        BinarySearchTree upper(comparator_);
+        upper.alloc_ = alloc_;
+        size_type limit = size_ / std::max<size_type>(std::bit_width(size_), 1);
+
+        size_type upper_count = 0;
+        for (auto it = end(); upper_count <= limit && it != begin() && !Less(*std::prev(it), key); --it) {
+            ++upper_count;
+        }
+        if (upper_count <= limit) {
+            for (; upper_count; --upper_count) {
+                Node* node = static_cast<Node*>(rightmost_);
+                Extract(node);
+                upper.LinkAsMinimum(node);
+            }
+            return upper;
+        }
+
+        size_type lower_count = 0;
+        for (auto it = begin(); lower_count <= limit && it != end() && Less(*it, key); ++it) {
+            ++lower_count;
+        }
+        if (lower_count <= limit) {
+            BinarySearchTree lower(comparator_);
+            lower.alloc_ = alloc_;
+            for (; lower_count; --lower_count) {
+                Node* node = static_cast<Node*>(fake_node_.right);
+                Extract(node);
+                lower.LinkAsMaximum(node);
+            }
+            upper.StealFrom(*this);
+            StealFrom(lower);
+            return upper;
+        }
+
+        NodeStream all(*this);
+        Vine lower_vine;
+        Vine upper_vine;
+        while (all.head) {
+            BaseNode* node = all.PopFront();
+            (Less(KeyOf(node), key) ? lower_vine : upper_vine).Append(node);
+        }
+        AdoptVine(lower_vine);
+        upper.AdoptVine(upper_vine);
+        return upper;
+    }
+
+    // все ключи left должны быть меньше всех ключей right; при равных аллокаторах ноды не копируются
+    static BinarySearchTree join(BinarySearchTree&& left, BinarySearchTree&& right) {
+        BinarySearchTree result(std::move(left));
+        result.JoinGreater(right);
+        return result;
+    }
+
+    // операции над множествами проходят меньшее дерево по возрастанию и ищут каждый следующий ключ в большем
+    // поиском пальцем от предыдущей позиции: для размеров k <= l это O(k log(l/k + 1)) сравнений.
+    // union_with обязан скопировать все недостающие ключи other, поэтому всегда идет по other:
+    // O(m log(n/m + 1)) для m = other.size(), что при m > n вырождается в O(m)
+    void union_with(const BinarySearchTree& other) {
+        if (this == &other) {
+            return;
+        }
+        BaseNode* finger = nullptr;
+        for (const Key& key: other) {
+            BaseNode* bound = FingerLowerBound(finger, key);
+            if (bound != &fake_node_ && !Less(key, KeyOf(bound))) {
+                finger = bound;
+                continue;
+            }
+            auto [parent, is_left] = PositionBefore(bound);
+            Node* node = AllocateNode();
+            AllocTraits::construct(alloc_, node, key);
+            Link(node, parent, is_left);
+            finger = node;
+        }
+    }
+
+    // если *this больше, совпавшие ноды вынимаются и переживают clear остальных: сравнений O(m log(n/m + 1)),
+    // плюс O(n) на освобождение выброшенных нод, без удалений по одной с перебалансировкой
+    void intersect_with(const BinarySearchTree& other) {
+        if (this == &other) {
+            return;
+        }
+        if (other.size_ < size_) {
+            BinarySearchTree kept(comparator_);
+            kept.alloc_ = alloc_;
+            BaseNode* finger = nullptr;
+            for (const Key& key: other) {
+                BaseNode* bound = FingerLowerBound(finger, key);
+                if (bound == &fake_node_) {
+                    break;
+                }
+                finger = bound;
+                if (!Less(key, KeyOf(bound))) {
+                    BaseNode* next = InOrderNext(bound);
+                    Extract(static_cast<Node*>(bound));
+                    kept.LinkAsMaximum(static_cast<Node*>(bound));
+                    finger = next == &fake_node_ ? nullptr : next;
+                }
+            }
+            clear();
+            StealFrom(kept);
+            return;
+        }
+        BaseNode* finger = nullptr;
+        for (auto it = begin(); it != end();) {
+            BaseNode* bound = other.FingerLowerBound(finger, *it);
+            if (bound == &other.fake_node_) {
+                erase(it, end());
+                return;
+            }
+            finger = bound;
+            it = Less(*it, KeyOf(bound)) ? erase(it) : std::next(it);
+        }
+    }
+
+    void difference_with(const BinarySearchTree& other) {
+        if (this == &other) {
+            clear();
+            return;
+        }
+        if (size_ < other.size_) {
+            BaseNode* finger = nullptr;
+            for (auto it = begin(); it != end();) {
+                BaseNode* bound = other.FingerLowerBound(finger, *it);
+                if (bound == &other.fake_node_) {
+                    return;
+                }
+                finger = bound;
+                it = Less(*it, KeyOf(bound)) ? std::next(it) : erase(it);
+            }
+            return;
+        }
+        BaseNode* finger = nullptr;
+        for (const Key& key: other) {
+            BaseNode* bound = FingerLowerBound(finger, key);
+            if (bound == &fake_node_) {
+                return;
+            }
+            finger = bound;
+            if (!Less(key, KeyOf(bound))) {
+                BaseNode* next = InOrderNext(bound);
+                Delete(static_cast<Node*>(bound));
+                finger = next == &fake_node_ ? nullptr : next;
+            }
+        }
+    }
+
+    // переносит из other ноды с ключами, которых нет в *this, как std::set::merge; совпадающие остаются в other.
+    // Ноды перевешиваются без выделения памяти, если аллокаторы равны
+    void merge(BinarySearchTree& other) {
+        if (this == &other || !other.size_) {
+            return;
+        }
+        if (!SharesAllocator(other)) {
+            for (auto it = other.begin(); it != other.end();) {
+                it = insert(*it).second ? other.erase(it) : std::next(it);
+            }
+            return;
+        }
+        if (!size_) {
+            StealFrom(other);
+            return;
+        }
+
+        BaseNode* finger = nullptr;
+        for (auto it = other.begin(); it != other.end();) {
+            Node* node = static_cast<Node*>(it.node_);
+            ++it;
+            BaseNode* bound = FingerLowerBound(finger, node->key);
+            if (bound != &fake_node_ && !Less(node->key, KeyOf(bound))) {
+                finger = bound;
+                continue;
+            }
+            auto [parent, is_left] = PositionBefore(bound);
+            other.Extract(node);
+            LinkDetached(node, parent, is_left);
+            finger = node;
+        }
+    }
+
+    void swap(BinarySearchTree& other) noexcept {
+        if (other.size_) {
+            other.fake_node_.left->parent = &fake_node_;
+        }
+        if (size_) {
+            fake_node_.left->parent = &(other.fake_node_);
+        }
+
+        std::swap(fake_node_, other.fake_node_);
+        std::swap(rightmost_, other.rightmost_);
+        std::swap(size_, other.size_);
+        std::swap(comparator_, other.comparator_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        std::swap(balance_state_, other.balance_state_);
+
+        if (!size_) {
+            fake_node_.left = &fake_node_;
+            fake_node_.right = fake_node_.left;
+            fake_node_.parent = fake_node_.left;
+        }
+        if (!other.size_) {
+            other.fake_node_.left = &other.fake_node_;
+            other.fake_node_.right = other.fake_node_.left;
+            other.fake_node_.parent = other.fake_node_.left;
+        }
+    }
+
+private:
+    // строит идеально сбалансированное дерево за O(n) без спусков от корня; *this должно быть пустым
+    template<typename Iter>
+    void BuildFromSorted(Iter iterator_start, Iter iterator_finish) {
+        if constexpr (std::forward_iterator<Iter> && requires { alloc_.reserve(size_type()); }) {
+            alloc_.reserve(std::distance(iterator_start, iterator_finish));
+        }
+
+        BaseNode* head = nullptr;
+        Node* tail = nullptr;
+        size_type count = 0;
+        for (; iterator_start != iterator_finish; ++iterator_start) {
+            if (tail && !Less(tail->key, *iterator_start)) {
+                continue;
+            }
+            Node* node = AllocateNode();
+            AllocTraits::construct(alloc_, node, *iterator_start);
+            if (tail) {
+                tail->right = node;
+            } else {
+                head = node;
+            }
+            tail = node;
+            ++count;
+        }
+        AdoptVine(Vine{head, tail, count});
+    }
+
+    // отсортированный список нод, связанных через right
+    struct Vine {
+        BaseNode* head = nullptr;
+        BaseNode* tail = nullptr;
+        size_type size = 0;
+
+        void Append(BaseNode* node) {
+            node->right = nullptr;
+            (tail ? tail->right : head) = node;
+            tail = node;
+            ++size;
+        }
+
+        BaseNode* PopFront() {
+            BaseNode* node = head;
+            head = head->right;
+            if (!head) {
+                tail = nullptr;
+            }
+            --size;
+            return node;
+        }
+    };
+
+    // собирает из списка идеально сбалансированное дерево и выставляет данные политики; *this должно быть пустым
+    void AdoptVine(Vine vine) {
+        if (!vine.size) {
+            return;
+        }
+        fake_node_.right = vine.head;
+        rightmost_ = vine.tail;
+        BaseNode* root = BuildBalanced(vine.head, vine.size);
+        root->parent = &fake_node_;
+        fake_node_.left = root;
+        fake_node_.parent = FirstLeaf(fake_node_.right);
+        size_ = vine.size;
+
+        size_type max_depth = 0;
+        while ((size_type(2) << max_depth) - 1 < size_) {
+            ++max_depth;
+        }
+        AfterBuild(max_depth, balancing_type{});
+    }
+
+    // выдает ноды дерева по возрастанию, сразу оставляя само дерево пустым. Следующая нода ищется до выдачи текущей,
+    // а подъем смотрит только на left предков, поэтому right выданных нод можно переписывать: ноды читаются
+    // и сливаются в новый список за один проход
+    class NodeStream {
+    public:
+        explicit NodeStream(BinarySearchTree& tree)
+            : head(tree.size_ ? tree.fake_node_.right : nullptr), root_(tree.size_ ? tree.fake_node_.left : nullptr) {
+            tree.size_ = 0;
+            tree.balance_state_ = {};
+            tree.SetDefaultFakeNodePointers();
+        }
+
+        BaseNode* PopFront() {
+            BaseNode* node = head;
+            if (node->right) {
+                head = Leftmost(node->right);
+            } else {
+                BaseNode* current = node;
+                while (current != root_ && current->parent->left != current) {
+                    current = current->parent;
+                }
+                head = current == root_ ? nullptr : current->parent;
+            }
+            return node;
+        }
+
+        BaseNode* head;
+
+    private:
+        BaseNode* root_;
+    };
+
+    Vine DetachVine() {
+        NodeStream stream(*this);
+        Vine vine;
+        while (stream.head) {
+            vine.Append(stream.PopFront());
+        }
+        return vine;
+    }
+
+    // добавляет ноды right, все ключи которого больше наших, и оставляет right пустым
+    void JoinGreater(BinarySearchTree& right) {
+        if (!right.size_) {
+            return;
+        }
+        if (!SharesAllocator(right)) {
+            for (const Key& key: right) {
+                insert(end(), key);
+            }
+            right.clear();
+            return;
+        }
+        if (!size_) {
+            StealFrom(right);
+            return;
+        }
+
+        if (PreferPerNode(right.size_, size_)) {
+            Vine vine = right.DetachVine();
+            while (vine.head) {
+                LinkAsMaximum(static_cast<Node*>(vine.PopFront()));
+            }
+        } else if (PreferPerNode(size_, right.size_)) {
+            // наши ноды встают минимумами в right по убыванию
+            Vine vine = DetachVine();
+            BaseNode* descending = nullptr;
+            while (vine.head) {
+                BaseNode* node = vine.PopFront();
+                node->right = descending;
+                descending = node;
+            }
+            StealFrom(right);
+            while (descending) {
+                BaseNode* next = descending->right;
+                LinkAsMinimum(static_cast<Node*>(descending));
+                descending = next;
+            }
+        } else {
+            Vine lower = DetachVine();
+            Vine upper = right.DetachVine();
+            lower.tail->right = upper.head;
+            lower.tail = upper.tail;
+            lower.size += upper.size;
+            AdoptVine(lower);
+        }
+    }
+
+    // нода из другого дерева или списка должна вставать как свежая: без детей и с данными политики по умолчанию
+    void LinkDetached(Node* node, BaseNode* parent, bool is_left) {
+        node->left = nullptr;
+        node->right = nullptr;
+        static_cast<BalanceData<balancing_type>&>(*node) = {};
+        static_cast<AugmentData<augmentation_type>&>(*node) = {};
+        Link(node, parent, is_left);
+    }
+
+    void LinkAsMaximum(Node* node) {
+        LinkDetached(node, size_ ? rightmost_ : &fake_node_, false);
+    }
+
+    void LinkAsMinimum(Node* node) {
+        LinkDetached(node, size_ ? fake_node_.right : &fake_node_, true);
+    }
+
+    // по одной ноде за O(log) выгоднее, чем пересобрать оба дерева за O(small + large)
+    static bool PreferPerNode(size_type small, size_type large) {
+        return small * std::bit_width(large) < small + large;
+    }
+
+    bool SharesAllocator(const BinarySearchTree& other) const {
+        return AllocTraits::is_always_equal::value || alloc_ == other.alloc_;
+    }
+
+    // забирает ноды other за O(1); *this должно быть пустым
+    void StealFrom(BinarySearchTree& other) {
+        if (other.empty()) {
+            return;
+        }
+        fake_node_ = other.fake_node_;
+        fake_node_.left->parent = &fake_node_;
+        rightmost_ = other.rightmost_;
+        size_ = other.size_;
+        balance_state_ = other.balance_state_;
+
+        other.SetDefaultFakeNodePointers();
+        other.size_ = 0;
+        other.balance_state_ = {};
+    }
+
+    // копирует форму дерева other за один проход без сравнений; *this должно быть пустым
+    void CloneFrom(const BinarySearchTree& other) {
+        if (other.empty()) {
+            return;
+        }
+        if constexpr (requires { alloc_.reserve(other.size_); }) {
+            alloc_.reserve(other.size_);
+        }
+
+        const BaseNode* source = other.fake_node_.left;
+        BaseNode* target = CloneNode(source);
+        target->parent = &fake_node_;
+        fake_node_.left = target;
+
+        while (true) {
+            if (source->left && !target->left) {
+                target->left = CloneNode(source->left);
+                target->left->parent = target;
+                source = source->left;
+                target = target->left;
+            } else if (source->right && !target->right) {
+                target->right = CloneNode(source->right);
+                target->right->parent = target;
+                source = source->right;
+                target = target->right;
+            } else if (source != other.fake_node_.left) {
+                source = source->parent;
+                target = target->parent;
+            } else {
+                break;
+            }
+        }
+
+        size_ = other.size_;
+        balance_state_ = other.balance_state_;
+        fake_node_.right = Leftmost(fake_node_.left);
+        rightmost_ = Rightmost(fake_node_.left);
+        SetPostOrderBegin();
+    }
+
+    Node* CloneNode(const BaseNode* source) {
+        const Node* source_node = static_cast<const Node*>(source);
+        Node* node = AllocateNode();
+        AllocTraits::construct(alloc_, node, source_node->key);
+        static_cast<BalanceData<balancing_type>&>(*node) = static_cast<const BalanceData<balancing_type>&>(*source_node);
+        static_cast<AugmentData<augmentation_type>&>(*node) = static_cast<const AugmentData<augmentation_type>&>(*source_node);
+        return node;
+    }
+
+    template<typename traversal_type, typename... Args>
+    std::pair<iterator<traversal_type>, bool> InsertUnique(const Key& key, Args&&... args) {
+        InsertPosition position = FindInsertPosition(key);
+        if (position.exists) {
+            AfterAccess(static_cast<Node*>(position.node), balancing_type{});
+            return std::make_pair(iterator<traversal_type>(position.node), false);
+        }
+
+        Node* new_node = AllocateNode();
+        AllocTraits::construct(alloc_, new_node, std::forward<Args>(args)...);
+        Link(new_node, position.node, position.is_left);
+        return std::make_pair(iterator<traversal_type>(new_node), true);
+    }
+
+    // родитель и сторона для новой ноды с ключом key, либо нода с таким же ключом
+    struct InsertPosition {
+        BaseNode* node;
+        bool is_left;
+        bool exists;
+    };
+
+    InsertPosition FindInsertPosition(const Key& key) {
+        InsertPosition position{&fake_node_, true, false};
+        size_type visited = 0;
+
+        if (size_ && Less(key, *begin())) {
+            position.node = fake_node_.right;
+            visited = 1;
+        } else if (size_ && Less(KeyOf(rightmost_), key)) {
+            position.node = rightmost_;
+            position.is_left = false;
+            visited = 1;
+        } else if (size_) {
+            Node* current = static_cast<Node*>(fake_node_.left);
+            while (true) {
+                ++visited;
+                if (Less(key, current->key)) {
+                    if (!current->left) {
+                        break;
+                    }
+                    current = static_cast<Node*>(current->left);
+                } else if (Less(current->key, key)) {
+                    if (!current->right) {
+                        position.is_left = false;
+                        break;
+                    }
+                    current = static_cast<Node*>(current->right);
+                } else {
+                    position.exists = true;
+                    break;
+                }
+            }
+            position.node = current;
+        }
+        RecordDescent(&TreeStats::insert, visited);
+        return position;
+    }
+
+    template<typename traversal_type, typename... Args>
+    iterator<traversal_type> InsertHinted(BaseNode* hint, const Key& key, Args&&... args) {
+        auto [parent, is_left] = HintedPosition(hint, key);
+        if (!parent) {
+            return InsertUnique<traversal_type>(key, std::forward<Args>(args)...).first;
+        }
+        RecordDescent(&TreeStats::insert, size_ ? 1 : 0);
+
+        Node* new_node = AllocateNode();
+        AllocTraits::construct(alloc_, new_node, std::forward<Args>(args)...);
+        Link(new_node, parent, is_left);
+        return iterator<traversal_type>(new_node);
+    }
+
+    // место для key рядом с hint: родитель и сторона, либо nullptr, если подсказка не подошла или key уже есть.
+    // Из двух соседних по порядку нод свободная ссылка в нужную сторону есть ровно у одной
+    std::pair<BaseNode*, bool> HintedPosition(BaseNode* hint, const Key& key) {
+        if (!size_) {
+            return std::make_pair(&fake_node_, true);
+        }
+        if (hint == &fake_node_ || Less(key, static_cast<Node*>(hint)->key)) {
+            BaseNode* previous = hint == &fake_node_ ? rightmost_ : (hint == fake_node_.right ? nullptr : InOrderPrevious(hint));
+            if (previous && !Less(static_cast<Node*>(previous)->key, key)) {
+                return std::make_pair(nullptr, false);
+            }
+            if (hint != &fake_node_ && !hint->left) {
+                return std::make_pair(hint, true);
+            }
+            return std::make_pair(previous, false);
+        }
+        if (Less(static_cast<Node*>(hint)->key, key)) {
+            BaseNode* next = hint == rightmost_ ? &fake_node_ : InOrderNext(hint);
+            if (next != &fake_node_ && !Less(key, static_cast<Node*>(next)->key)) {
+                return std::make_pair(nullptr, false);
+            }
+            if (!hint->right) {
+                return std::make_pair(hint, false);
+            }
+            return std::make_pair(next, true);
+        }
+        return std::make_pair(nullptr, false);
+    }
+
+    // место для нового ключа сразу перед bound (end() - после максимума) без сравнений
+    std::pair<BaseNode*, bool> PositionBefore(BaseNode* bound) {
+        if (!size_) {
+            return std::make_pair(&fake_node_, true);
+        }
+        if (bound == &fake_node_) {
+            return std::make_pair(rightmost_, false);
+        }
+        if (!bound->left) {
+            return std::make_pair(bound, true);
+        }
+        return std::make_pair(Rightmost(bound->left), false);
+    }
+
+    void Link(Node* node, BaseNode* parent, bool is_left) {
+        ++size_;
+        node->parent = parent;
+        if (parent == &fake_node_) {
+            fake_node_.left = node;
+            fake_node_.right = node;
+            fake_node_.parent = node;
+            rightmost_ = node;
+            FixAfterInsert(node, balancing_type{});
+            return;
+        }
+
+        if (is_left) {
+            parent->left = node;
+            if (parent == fake_node_.right) {
+                fake_node_.right = node;
+            }
+        } else {
+            parent->right = node;
+            if (parent == rightmost_) {
+                rightmost_ = node;
+            }
+        }
+        UpdateSubtreeSizesUpwards(parent);
+        FixAfterInsert(node, balancing_type{});
+        SetPostOrderBegin();
+    }
+
+    void Delete(Node* node) {
+        Extract(node);
+        DestroyNode(node);
+    }
+
+    // вынимает ноду из дерева, не освобождая ее
+    void Extract(Node* node) {
+        --size_;
+
+        if (node == fake_node_.right) {
+            fake_node_.right = InOrderNext(node);
+        }
+        if (node == rightmost_) {
+            rightmost_ = size_ ? InOrderPrevious(node) : nullptr;
+        }
+
+        Unlink(node, balancing_type{});
+        SetPostOrderBegin();
+    }
+
+    void DestroyNode(Node* node) {
+        AllocTraits::destroy(alloc_, node);
+        DeallocateNode(node);
+    }
+
+    static const Key& KeyOf(const BaseNode* node) {
+        return static_cast<const Node*>(node)->key;
+    }
+
+    bool Less(const Key& first, const Key& second) const {
+        if constexpr (kStats) {
+            ++stats_.comparisons;
+        }
+        return comparator_(first, second);
+    }
+
+    // спускается по дереву за группой из kSearchGroup ключей сразу: за один проход каждый поиск делает шаг
+    // и запрашивает следующую ноду, так что промахи кеша разных поисков ждутся одновременно
+    template<bool kLowerBound, typename OnResult>
+    void DescendMany(std::span<const Key> keys, OperationStats TreeStats::* operation, OnResult on_result) const {
+        for (size_t group = 0; group < keys.size(); group += kSearchGroup) {
+            size_t count = std::min(kSearchGroup, keys.size() - group);
+            // корень перечитывается для каждой группы: splay мог его сменить
+            Node* root = size_ ? static_cast<Node*>(fake_node_.left) : nullptr;
+            Node* current[kSearchGroup];
+            Node* found[kSearchGroup];
+            size_type visited[kSearchGroup] = {};
+            for (size_t i = 0; i < count; ++i) {
+                current[i] = root;
+                found[i] = nullptr;
+            }
+
+            for (bool active = root != nullptr; active;) {
+                active = false;
+                for (size_t i = 0; i < count; ++i) {
+                    Node* node = current[i];
+                    if (!node) {
+                        continue;
+                    }
+                    ++visited[i];
+                    const Key& key = keys[group + i];
+                    if (Less(node->key, key)) {
+                        node = static_cast<Node*>(node->right);
+                    } else if (kLowerBound) {
+                        found[i] = node;
+                        node = static_cast<Node*>(node->left);
+                    } else if (Less(key, node->key)) {
+                        node = static_cast<Node*>(node->left);
+                    } else {
+                        found[i] = node;
+                        node = nullptr;
+                    }
+                    current[i] = node;
+                    if (node) {
+                        __builtin_prefetch(node);
+                        active = true;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                RecordDescent(operation, visited[i]);
+                if (found[i]) {
+                    AfterAccess(found[i], balancing_type{});
+                }
+                on_result(group + i, found[i]);
+            }
+        }
+    }
+
+    // подъем от finger: пока key правее поддерева, идем к ближайшему предку, для которого оно левое, и наоборот.
+    // Как только key попал между нодой и границей ее поддерева, спускаемся обычным lower_bound
+    BaseNode* FingerLowerBound(BaseNode* node, const Key& key) const {
+        if (!size_) {
+            return &fake_node_;
+        }
+        if (!node) {
+            node = fake_node_.left;
+        }
+
+        BaseNode* best = &fake_node_;
+        size_type visited = 0;
+        while (true) {
+            ++visited;
+            if (Less(static_cast<Node*>(node)->key, key)) {
+                BaseNode* child = node;
+                while (!IsRoot(child) && child->parent->right == child) {
+                    child = child->parent;
+                }
+                BaseNode* upper = IsRoot(child) ? &fake_node_ : child->parent;
+                if (upper == &fake_node_ || Less(key, static_cast<Node*>(upper)->key)) {
+                    best = upper;
+                    node = node->right;
+                    break;
+                }
+                node = upper;
+            } else if (!Less(key, static_cast<Node*>(node)->key)) {
+                RecordDescent(&TreeStats::lower_bound, visited);
+                return node;
+            } else {
+                BaseNode* child = node;
+                while (!IsRoot(child) && child->parent->left == child) {
+                    child = child->parent;
+                }
+                if (IsRoot(child) || Less(static_cast<Node*>(child->parent)->key, key)) {
+                    best = node;
+                    node = node->left;
+                    break;
+                }
+                node = child->parent;
+            }
+        }
+
+        while (node) {
+            ++visited;
+            if (Less(static_cast<Node*>(node)->key, key)) {
+                node = node->right;
+            } else {
+                best = node;
+                node = node->left;
+            }
+        }
+        RecordDescent(&TreeStats::lower_bound, visited);
+        return best;
+    }
+
+    void RecordDescent(OperationStats TreeStats::* operation, size_type visited) const {
+        if constexpr (kStats) {
+            ++(stats_.*operation).calls;
+            (stats_.*operation).nodes_visited += visited;
+            stats_.max_depth = std::max(stats_.max_depth, visited);
+            ++stats_.depth_histogram[std::min(visited, TreeStats::kDepthBuckets - 1)];
+        }
+    }
+
+    Node* AllocateNode() {
+        if constexpr (kStats) {
+            ++stats_.allocations;
+        }
+        return alloc_.allocate(1);
+    }
+
+    void DeallocateNode(Node* node) {
+        if constexpr (kStats) {
+            ++stats_.deallocations;
+        }
+        alloc_.deallocate(node, 1);
+    }
+
+    // вырезает ноду из дерева, возвращает поддерево, вставшее на освободившееся место, и его родителя
+    std::pair<BaseNode*, BaseNode*> Splice(Node* node) {
+        if (!node->left || !node->right) {
+            BaseNode* child = node->left ? node->left : node->right;
+            BaseNode* parent = node->parent;
+            Transplant(node, child);
+            UpdateSubtreeSizesUpwards(parent);
+            return std::make_pair(child, parent);
+        }
+
+        BaseNode* successor = Leftmost(node->right);
+        BaseNode* child = successor->right;
+        BaseNode* parent = successor;
+        if (successor->parent != node) {
+            parent = successor->parent;
+            Transplant(successor, child);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        Transplant(node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+
+        std::swap(static_cast<BalanceData<balancing_type>&>(*node), static_cast<BalanceData<balancing_type>&>(*static_cast<Node*>(successor)));
+        UpdateSubtreeSizesUpwards(parent);
+        return std::make_pair(child, parent);
+    }
+
+    static void Transplant(BaseNode* node, BaseNode* replacement) {
+        ReplaceChild(node->parent, node, replacement);
+        if (replacement) {
+            replacement->parent = node->parent;
+        }
+    }
+
+    static void ReplaceChild(BaseNode* parent, BaseNode* old_child, BaseNode* new_child) {
+        if (parent->left == old_child) {
+            parent->left = new_child;
+        } else {
+            parent->right = new_child;
+        }
+    }
+
+    static void RotateLeft(BaseNode* node) {
+        BaseNode* pivot = node->right;
+        node->right = pivot->left;
+        if (pivot->left) {
+            pivot->left->parent = node;
+        }
+        Transplant(node, pivot);
+        pivot->left = node;
+        node->parent = pivot;
+        UpdateSubtreeSize(node);
+        UpdateSubtreeSize(pivot);
+    }
+
+    static void RotateRight(BaseNode* node) {
+        BaseNode* pivot = node->left;
+        node->left = pivot->right;
+        if (pivot->right) {
+            pivot->right->parent = node;
+        }
+        Transplant(node, pivot);
+        pivot->right = node;
+        node->parent = pivot;
+        UpdateSubtreeSize(node);
+        UpdateSubtreeSize(pivot);
+    }
+
+    static size_type SubtreeSize(const BaseNode* node) {
+        if (!node) {
+            return 0;
+        }
+        if constexpr (kSubtreeSizes) {
+            return static_cast<const Node*>(node)->subtree_size;
+        } else {
+            return SubtreeSize(node->left) + SubtreeSize(node->right) + 1;
+        }
+    }
+
+    static void UpdateSubtreeSize(BaseNode* node) {
+        if constexpr (kSubtreeSizes) {
+            static_cast<Node*>(node)->subtree_size = SubtreeSize(node->left) + SubtreeSize(node->right) + 1;
+        }
+    }
+
+    void UpdateSubtreeSizesUpwards(BaseNode* node) {
+        if constexpr (kSubtreeSizes) {
+            for (; node != &fake_node_; node = node->parent) {
+                UpdateSubtreeSize(node);
+            }
+        }
+    }
+
+    static BaseNode* SelectNode(BaseNode* fake_node, size_type index) {
+        if (fake_node->left == fake_node || index >= SubtreeSize(fake_node->left)) {
+            return fake_node;
+        }
+        BaseNode* current = fake_node->left;
+        while (true) {
+            size_type left_size = SubtreeSize(current->left);
+            if (index < left_size) {
+                current = current->left;
+            } else if (index > left_size) {
+                index -= left_size + 1;
+                current = current->right;
+            } else {
+                return current;
+            }
+        }
+    }
+
+    // ноды при удалении перевешиваются, а не копируются, поэтому in-order преемник остается валидным после Delete
+    static BaseNode* InOrderNext(BaseNode* node) {
+        return (++iterator<InOrder>(node)).node_;
+    }
+
+    static BaseNode* InOrderPrevious(BaseNode* node) {
+        return (--iterator<InOrder>(node)).node_;
+    }
+
+    static BaseNode* Leftmost(BaseNode* node) {
+        while (node->left) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    static BaseNode* Rightmost(BaseNode* node) {
+        while (node->right) {
+            node = node->right;
+        }
+        return node;
+    }
+
+    bool IsRoot(const BaseNode* node) const {
+        return node == fake_node_.left;
+    }
+
+    template<typename any_balancing_type>
+    void AfterAccess(Node*, any_balancing_type) const {}
+
+    template<typename any_balancing_type>
+    void AfterBuild(size_type, any_balancing_type) {}
+
+    void FixAfterInsert(Node*, Unbalanced) {}
+
+    void Unlink(Node* node, Unbalanced) {
+        Splice(node);
+    }
+
+    static bool IsRed(const BaseNode* node) {
+        return node && static_cast<const Node*>(node)->red;
+    }
+
+    static void SetRed(BaseNode* node, bool red) {
+        static_cast<Node*>(node)->red = red;
+    }
+
+    void FixAfterInsert(Node* node, RedBlack) {
+        BaseNode* current = node;
+        while (!IsRoot(current) && IsRed(current->parent)) {
+            BaseNode* parent = current->parent;
+            BaseNode* grandparent = parent->parent;
+
+            if (parent == grandparent->left) {
+                BaseNode* uncle = grandparent->right;
+                if (IsRed(uncle)) {
+                    SetRed(parent, false);
+                    SetRed(uncle, false);
+                    SetRed(grandparent, true);
+                    current = grandparent;
+                    continue;
+                }
+                if (current == parent->right) {
+                    RotateLeft(parent);
+                    parent = current;
+                }
+                SetRed(parent, false);
+                SetRed(grandparent, true);
+                RotateRight(grandparent);
+                break;
+            } else {
+                BaseNode* uncle = grandparent->left;
+                if (IsRed(uncle)) {
+                    SetRed(parent, false);
+                    SetRed(uncle, false);
+                    SetRed(grandparent, true);
+                    current = grandparent;
+                    continue;
+                }
+                if (current == parent->left) {
+                    RotateRight(parent);
+                    parent = current;
+                }
+                SetRed(parent, false);
+                SetRed(grandparent, true);
+                RotateLeft(grandparent);
+                break;
+            }
+        }
+        SetRed(fake_node_.left, false);
+    }
+
+    // в дереве от BuildBalanced все пустые ссылки лежат на двух последних уровнях, поэтому красным достаточно сделать нижний
+    static void ColorByDepth(BaseNode* node, size_type depth, size_type max_depth) {
+        if (!node) {
+            return;
+        }
+        SetRed(node, depth && depth == max_depth);
+        ColorByDepth(node->left, depth + 1, max_depth);
+        ColorByDepth(node->right, depth + 1, max_depth);
+    }
+
+    void AfterBuild(size_type max_depth, RedBlack) {
+        ColorByDepth(fake_node_.left, 0, max_depth);
+    }
+
+    void Unlink(Node* node, RedBlack) {
+        auto [current, parent] = Splice(node);
+        if (node->red) {
+            return;
+        }
+
+        // current несет лишний черный цвет, пока не дойдем до красной ноды или корня
+        while (!IsRoot(current) && !IsRed(current)) {
+            if (current == parent->left) {
+                BaseNode* sibling = parent->right;
+                if (IsRed(sibling)) {
+                    SetRed(sibling, false);
+                    SetRed(parent, true);
+                    RotateLeft(parent);
+                    sibling = parent->right;
+                }
+                if (!IsRed(sibling->left) && !IsRed(sibling->right)) {
+                    SetRed(sibling, true);
+                    current = parent;
+                    parent = current->parent;
+                    continue;
+                }
+                if (!IsRed(sibling->right)) {
+                    SetRed(sibling->left, false);
+                    SetRed(sibling, true);
+                    RotateRight(sibling);
+                    sibling = parent->right;
+                }
+                SetRed(sibling, IsRed(parent));
+                SetRed(parent, false);
+                SetRed(sibling->right, false);
+                RotateLeft(parent);
+            } else {
+                BaseNode* sibling = parent->left;
+                if (IsRed(sibling)) {
+                    SetRed(sibling, false);
+                    SetRed(parent, true);
+                    RotateRight(parent);
+                    sibling = parent->left;
+                }
+                if (!IsRed(sibling->left) && !IsRed(sibling->right)) {
+                    SetRed(sibling, true);
+                    current = parent;
+                    parent = current->parent;
+                    continue;
+                }
+                if (!IsRed(sibling->left)) {
+                    SetRed(sibling->right, false);
+                    SetRed(sibling, true);
+                    RotateLeft(sibling);
+                    sibling = parent->left;
+                }
+                SetRed(sibling, IsRed(parent));
+                SetRed(parent, false);
+                SetRed(sibling->left, false);
+                RotateRight(parent);
+            }
+            return;
+        }
+        if (current) {
+            SetRed(current, false);
+        }
+    }
+
+    static int Height(const BaseNode* node) {
+        return node ? static_cast<const Node*>(node)->height : 0;
+    }
+
+    static int BalanceFactor(const BaseNode* node) {
+        return Height(node->left) - Height(node->right);
+    }
+
+    static void UpdateHeight(BaseNode* node) {
+        static_cast<Node*>(node)->height = std::max(Height(node->left), Height(node->right)) + 1;
+    }
+
+    // поднимается от node к корню, пересчитывая высоты; останавливается, когда высота поддерева перестала меняться
+    void Retrace(BaseNode* node) {
+        while (node != &fake_node_) {
+            int old_height = Height(node);
+            UpdateHeight(node);
+
+            if (BalanceFactor(node) > 1) {
+                if (BalanceFactor(node->left) < 0) {
+                    RotateLeft(node->left);
+                    UpdateHeight(node->left->left);
+                    UpdateHeight(node->left);
+                }
+                RotateRight(node);
+                UpdateHeight(node);
+                node = node->parent;
+                UpdateHeight(node);
+            } else if (BalanceFactor(node) < -1) {
+                if (BalanceFactor(node->right) > 0) {
+                    RotateRight(node->right);
+                    UpdateHeight(node->right->right);
+                    UpdateHeight(node->right);
+                }
+                RotateLeft(node);
+                UpdateHeight(node);
+                node = node->parent;
+                UpdateHeight(node);
+            } else if (old_height == Height(node)) {
+                return;
+            }
+            node = node->parent;
+        }
+    }
+
+    void FixAfterInsert(Node* node, AVL) {
+        Retrace(node->parent);
+    }
+
+    static int ComputeHeights(BaseNode* node) {
+        if (!node) {
+            return 0;
+        }
+        static_cast<Node*>(node)->height = std::max(ComputeHeights(node->left), ComputeHeights(node->right)) + 1;
+        return Height(node);
+    }
+
+    void AfterBuild(size_type, AVL) {
+        ComputeHeights(fake_node_.left);
+    }
+
+    void Unlink(Node* node, AVL) {
+        Retrace(Splice(node).second);
+    }
+
+    static unsigned NextPriority() {
+        static thread_local unsigned state = 2463534242u;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    static unsigned Priority(const BaseNode* node) {
+        return static_cast<const Node*>(node)->priority;
+    }
+
+    void FixAfterInsert(Node* node, Treap) {
+        node->priority = NextPriority();
+        while (!IsRoot(node) && Priority(node->parent) < node->priority) {
+            if (node->parent->left == node) {
+                RotateRight(node->parent);
+            } else {
+                RotateLeft(node->parent);
+            }
+        }
+    }
+
+    // приоритеты случайны внутри полосы своего уровня, полосы убывают с глубиной - свойство кучи выполняется
+    static void AssignPriorities(BaseNode* node, size_type depth, unsigned band) {
+        if (!node) {
+            return;
+        }
+        static_cast<Node*>(node)->priority = std::numeric_limits<unsigned>::max() - depth * band - NextPriority() % band;
+        AssignPriorities(node->left, depth + 1, band);
+        AssignPriorities(node->right, depth + 1, band);
+    }
+
+    void AfterBuild(size_type max_depth, Treap) {
+        AssignPriorities(fake_node_.left, 0, std::numeric_limits<unsigned>::max() / (max_depth + 1));
+    }
+
+    void Unlink(Node* node, Treap) {
+        while (node->left && node->right) {
+            if (Priority(node->left) > Priority(node->right)) {
+                RotateRight(node);
+            } else {
+                RotateLeft(node);
+            }
+        }
+        Splice(node);
+    }
+
+    void SplayToRoot(BaseNode* node) const {
+        while (!IsRoot(node)) {
+            BaseNode* parent = node->parent;
+            bool is_left = parent->left == node;
+            if (IsRoot(parent)) {
+                is_left ? RotateRight(parent) : RotateLeft(parent);
+                continue;
+            }
+
+            BaseNode* grandparent = parent->parent;
+            bool parent_is_left = grandparent->left == parent;
+            if (is_left == parent_is_left) {
+                is_left ? RotateRight(grandparent) : RotateLeft(grandparent);
+                is_left ? RotateRight(parent) : RotateLeft(parent);
+            } else {
+                is_left ? RotateRight(parent) : RotateLeft(parent);
+                is_left ? RotateLeft(grandparent) : RotateRight(grandparent);
+            }
+        }
+    }
+
+    void AfterAccess(Node* node, Splay) const {
+        SplayToRoot(node);
+        fake_node_.parent = FirstLeaf(fake_node_.right);
+    }
+
+    void FixAfterInsert(Node* node, Splay) {
+        SplayToRoot(node);
+    }
+
+    void Unlink(Node* node, Splay) {
+        SplayToRoot(node);
+        Splice(node);
+    }
+
+    // alpha = 2/3: поддерево перестраивается, если один из сыновей тяжелее 2/3 всего поддерева
+    // выстраивает поддерево в список по возрастанию, связанный через right
+    static BaseNode* Flatten(BaseNode* node, BaseNode* tail) {
+        if (!node) {
+            return tail;
+        }
+        node->right = Flatten(node->right, tail);
+        return Flatten(node->left, node);
+    }
+
+    // строит идеально сбалансированное дерево из первых count нод списка и сдвигает head за них
+    static BaseNode* BuildBalanced(BaseNode*& head, size_type count) {
+        if (!count) {
+            return nullptr;
+        }
+        BaseNode* left = BuildBalanced(head, count / 2);
+        BaseNode* root = head;
+        head = head->right;
+
+        root->left = left;
+        if (left) {
+            left->parent = root;
+        }
+        root->right = BuildBalanced(head, count - count / 2 - 1);
+        if (root->right) {
+            root->right->parent = root;
+        }
+        if constexpr (kSubtreeSizes) {
+            static_cast<Node*>(root)->subtree_size = count;
+        }
+        return root;
+    }
+
+    static void Rebuild(BaseNode* node, size_type count) {
+        BaseNode* parent = node->parent;
+        BaseNode* head = Flatten(node, nullptr);
+        BaseNode* root = BuildBalanced(head, count);
+        ReplaceChild(parent, node, root);
+        root->parent = parent;
+    }
+
+    void FixAfterInsert(Node* node, Scapegoat) {
+        balance_state_.max_size = std::max(balance_state_.max_size, size_);
+
+        size_type depth = 0;
+        for (BaseNode* current = node; !IsRoot(current); current = current->parent) {
+            ++depth;
+        }
+        if (depth <= std::log(static_cast<double>(size_)) / std::log(1.5)) {
+            return;
+        }
+
+        BaseNode* child = node;
+        size_type child_size = 1;
+        while (!IsRoot(child)) {
+            BaseNode* parent = child->parent;
+            BaseNode* sibling = parent->left == child ? parent->right : parent->left;
+            size_type parent_size = child_size + SubtreeSize(sibling) + 1;
+            if (3 * child_size > 2 * parent_size) {
+                Rebuild(parent, parent_size);
+                return;
+            }
+            child = parent;
+            child_size = parent_size;
+        }
+    }
+
+    void AfterBuild(size_type, Scapegoat) {
+        balance_state_.max_size = size_;
+    }
+
+    void Unlink(Node* node, Scapegoat) {
+        Splice(node);
+        if (3 * size_ < 2 * balance_state_.max_size) {
+            if (size_) {
+                Rebuild(fake_node_.left, size_);
+            }
+            balance_state_.max_size = size_;
+        }
+    }
+
+    void SetPostOrderBegin() {
+        if (empty()) {
+            SetDefaultFakeNodePointers();
+            return;
+        }
+        fake_node_.parent = FirstLeaf(fake_node_.right);
+    }
+
+    size_t SplitDepth(const WorkStealingPool& pool) const {
+        return std::bit_width(pool.thread_count() * kTasksPerThread);
+    }
+
+    // in-order обход поддерева по ссылкам на родителя, не выходя за его корень
+    template<typename Visit>
+    static void VisitInOrder(const BaseNode* root, Visit&& visit) {
+        if (!root) {
+            return;
+        }
+        const BaseNode* node = Leftmost(const_cast<BaseNode*>(root));
+        while (true) {
+            visit(node);
+            if (node->right) {
+                node = Leftmost(node->right);
+                continue;
+            }
+            while (node != root && node->parent->right == node) {
+                node = node->parent;
+            }
+            if (node == root) {
+                return;
+            }
+            node = node->parent;
+        }
+    }
+
+    template<typename Function>
+    void ForEachParallel(const BaseNode* node, Function& function, WorkStealingPool& pool, size_t depth) const {
+        if (depth == 0) {
+            VisitInOrder(node, [&](const BaseNode* current) { function(KeyOf(current)); });
+            return;
+        }
+        pool.invoke(
+            [&] {
+                if (node->left) {
+                    ForEachParallel(node->left, function, pool, depth - 1);
+                }
+                function(KeyOf(node));
+            },
+            [&] {
+                if (node->right) {
+                    ForEachParallel(node->right, function, pool, depth - 1);
+                }
+            });
+    }
+
+    template<typename T, typename Reduce, typename Transform>
+    static T FoldSequential(const BaseNode* root, Reduce& reduce, Transform& transform) {
+        std::optional<T> result;
+        VisitInOrder(root, [&](const BaseNode* node) {
+            if (result) {
+                result.emplace(reduce(std::move(*result), T(transform(KeyOf(node)))));
+            } else {
+                result.emplace(transform(KeyOf(node)));
+            }
+        });
+        return std::move(*result);
+    }
+
+    // свертка непустого поддерева: левое поддерево, ключ корня, правое - именно в таком порядке
+    template<typename T, typename Reduce, typename Transform>
+    T FoldParallel(const BaseNode* node, Reduce& reduce, Transform& transform, WorkStealingPool& pool, size_t depth) const {
+        if (depth == 0) {
+            return FoldSequential<T>(node, reduce, transform);
+        }
+        std::optional<T> left;
+        std::optional<T> right;
+        pool.invoke(
+            [&] {
+                if (node->left) {
+                    left.emplace(FoldParallel<T>(node->left, reduce, transform, pool, depth - 1));
+                }
+            },
+            [&] {
+                if (node->right) {
+                    right.emplace(FoldParallel<T>(node->right, reduce, transform, pool, depth - 1));
+                }
+            });
+        T result(transform(KeyOf(node)));
+        if (left) {
+            result = reduce(std::move(*left), std::move(result));
+        }
+        if (right) {
+            result = reduce(std::move(result), std::move(*right));
+        }
+        return result;
+    }
+
+    // корень освобождается последним: до него обе половины уже не используют его ссылки
+    void DestroyParallel(BaseNode* node, WorkStealingPool& pool, size_t depth) {
+        if (depth == 0) {
+            DestroySubtree(node);
+            return;
+        }
+        pool.invoke(
+            [&] {
+                if (node->left) {
+                    DestroyParallel(node->left, pool, depth - 1);
+                }
+            },
+            [&] {
+                if (node->right) {
+                    DestroyParallel(node->right, pool, depth - 1);
+                }
+            });
+        DestroyNode(static_cast<Node*>(node));
+    }
+
+    // post-order как в clear, но в пределах поддерева
+    void DestroySubtree(BaseNode* root) {
+        BaseNode* node = FirstLeaf(root);
+        while (node != root) {
+            BaseNode* parent = node->parent;
+            BaseNode* next = parent;
+            if (parent->left == node && parent->right) {
+                next = FirstLeaf(parent->right);
+            }
+            DestroyNode(static_cast<Node*>(node));
+            node = next;
+        }
+        DestroyNode(static_cast<Node*>(root));
+    }
+
+    static BaseNode* FirstLeaf(BaseNode* node) {
+        while (node->left || node->right) {
+            if (node->left) {
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return node;
+    }
+
+    void SetDefaultFakeNodePointers() {
+        fake_node_.left = &fake_node_;
+        fake_node_.right = fake_node_.left;
+        fake_node_.parent = fake_node_.left;
+        rightmost_ = nullptr;
+    }
+
+    const_iterator<InOrder> cbegin(InOrder) const {
+        return iterator<InOrder>(fake_node_.right);
+    }
+
+
+    const_iterator<PreOrder> cbegin(PreOrder) const {
+        return iterator<PreOrder>(fake_node_.left);
+    }
+
+    const_iterator<PostOrder> cbegin(PostOrder) const {
+        return iterator<PostOrder>(fake_node_.parent);
+    }
+
+
+    // у splay-дерева корень меняется и при поиске
+    mutable BaseNode fake_node_;
+    // максимум хранится отдельно: все три ссылки фиктивной ноды заняты, а вставка в конец должна быть O(1)
+    BaseNode* rightmost_ = nullptr;
+    size_type size_ = 0;
+    [[no_unique_address]] BalanceState<balancing_type> balance_state_;
+
+    // поиск в const-дереве тоже пишет в счетчики
+    [[no_unique_address]] mutable StatsData<stats_type> stats_;
+
+    Compare comparator_;
+};
+
+
+
+template<typename Key, typename Compare, typename Allocator, typename balancing_type, typename augmentation_type, typename stats_type>
+void swap(BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& first, BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& second) {
+    first.swap(second);
+}
+
+template<typename Key, typename Compare, typename Allocator, typename balancing_type, typename augmentation_type, typename stats_type>
+bool operator==(const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& first, const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& second) {
+    if (first.size() != second.size()) {
+        return false;
+    }
+    auto iterator_first = first.begin();
+    auto iterator_second = second.begin();
+
+    while (iterator_first != first.end()) {
+        if (*iterator_first != *iterator_second) {
+            std::cout << *iterator_first << ' ' << *iterator_second << '\n';
+            return false;
+        }
+        ++iterator_first;
+        ++iterator_second;
+    }
+
+    return true;
+}
+
+template<typename Key, typename Compare, typename Allocator, typename balancing_type, typename augmentation_type, typename stats_type>
+bool operator!=(const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& first, const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& second) {
+    return !(first == second);
+}
+
+template<typename Key, typename Compare, typename Allocator, typename balancing_type, typename augmentation_type, typename stats_type, typename Function>
+void parallel_for_each(const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& tree, Function function) {
+    tree.parallel_for_each(std::move(function));
+}
+
+template<typename Key, typename Compare, typename Allocator, typename balancing_type, typename augmentation_type, typename stats_type, typename T, typename Reduce>
+T parallel_reduce(const BinarySearchTree<Key, Compare, Allocator, balancing_type, augmentation_type, stats_type>& tree, T init, Reduce reduce) {
+    return tree.parallel_reduce(std::move(init), std::move(reduce));
+}
+
+
+
+
+
+
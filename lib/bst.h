@@ -1,12 +1,102 @@
-#pragma once
-
-#include <iostream>
-#include <functional>
-
-struct InOrder {};
-struct PostOrder {};
-struct PreOrder {};
-
-
-
-
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <functional>
+
+struct InOrder {};
+struct PostOrder {};
+struct PreOrder {};
+
+struct AssumeSorted {};
+inline constexpr AssumeSorted assume_sorted {};
+
+struct Unbalanced {};
+struct RedBlack {};
+struct AVL {};
+struct Treap {};
+struct Splay {};
+struct Scapegoat {};
+
+template<typename balancing_type>
+struct BalanceData {};
+
+template<>
+struct BalanceData<RedBlack> {
+    bool red = true;
+};
+
+template<>
+struct BalanceData<AVL> {
+    int height = 1;
+};
+
+template<>
+struct BalanceData<Treap> {
+    unsigned priority = 0;
+};
+
+template<typename balancing_type>
+struct BalanceState {};
+
+template<>
+struct BalanceState<Scapegoat> {
+    size_t max_size = 0;
+};
+
+struct NoAugmentation {};
+struct OrderStatistics {};
+
+template<typename augmentation_type>
+struct AugmentData {};
+
+template<>
+struct AugmentData<OrderStatistics> {
+    size_t subtree_size = 1;
+};
+
+struct NoStats {};
+struct CollectStats {};
+
+struct OperationStats {
+    size_t calls = 0;
+    size_t nodes_visited = 0;
+};
+
+struct TreeStats {
+    static constexpr size_t kDepthBuckets = 64;
+
+    size_t comparisons = 0;
+    OperationStats find;
+    OperationStats lower_bound;
+    OperationStats upper_bound;
+    OperationStats insert;
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    // глубина спуска — число нод, пройденных одной операцией поиска или вставки; последняя корзина собирает все более глубокие
+    size_t max_depth = 0;
+    size_t depth_histogram[kDepthBuckets] = {};
+};
+
+template<typename stats_type>
+struct StatsData {};
+
+template<>
+struct StatsData<CollectStats>: TreeStats {};
+
+struct ParentLinks {};
+struct NoParentLinks {};
+
+// ссылки компактной ноды - индексы в массиве нод, 0 означает отсутствие ноды
+template<typename link_type>
+struct CompactLinks {
+    uint32_t left = 0;
+    uint32_t right = 0;
+};
+
+template<>
+struct CompactLinks<ParentLinks> {
+    uint32_t left = 0;
+    uint32_t right = 0;
+    uint32_t parent = 0;
+};
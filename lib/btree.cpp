@@ -0,0 +1,782 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bst.h"
+
+// B-дерево с тем же интерфейсом, что у BinarySearchTree, но только с in-order обходом:
+// узел держит до kMaxKeys ключей подряд, поэтому на ключ приходится несколько байт служебных данных, а не три указателя.
+// Правила инвалидации строже, чем у BinarySearchTree: insert и erase сдвигают ключи внутри узлов и переносят их
+// между узлами, поэтому делают недействительными все итераторы, кроме end(). end() не привязан к листу и
+// остается валидным до swap, перемещения или разрушения дерева
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class BTree {
+private:
+    static constexpr size_t kMaxKeys = std::clamp<size_t>(256 / sizeof(Key), 16, 64);
+    // после разделения полного узла в правой половине остается (kMaxKeys - 1) / 2 ключей
+    static constexpr size_t kMinKeys = (kMaxKeys - 1) / 2;
+
+    struct InternalNode;
+
+    struct LeafNode {
+        InternalNode* parent = nullptr;
+        uint8_t position = 0;
+        uint8_t count = 0;
+        bool leaf = true;
+        alignas(Key) unsigned char storage[kMaxKeys * sizeof(Key)];
+
+        Key* key(size_t index) {
+            return std::launder(reinterpret_cast<Key*>(storage)) + index;
+        }
+
+        const Key* key(size_t index) const {
+            return std::launder(reinterpret_cast<const Key*>(storage)) + index;
+        }
+    };
+
+    struct InternalNode: LeafNode {
+        InternalNode() {
+            this->leaf = false;
+        }
+
+        LeafNode* children[kMaxKeys + 1];
+    };
+
+    class Iterator {
+        friend BTree;
+
+    public:
+        using pointer_type = const Key*;
+        using reference_type = const Key&;
+        using pointer = const Key*;
+        using reference = const Key&;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Key;
+        using key_type = Key;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        Iterator() = default;
+
+        reference operator*() const {
+            return *node_->key(position_);
+        }
+
+        pointer operator->() const {
+            return node_->key(position_);
+        }
+
+        Iterator& operator++() {
+            if (!node_->leaf) {
+                node_ = Leftmost(static_cast<InternalNode*>(node_)->children[position_ + 1]);
+                position_ = 0;
+                return *this;
+            }
+            if (++position_ < node_->count) {
+                return *this;
+            }
+            while (position_ == node_->count && node_->parent) {
+                position_ = node_->position;
+                node_ = node_->parent;
+            }
+            // поднялись из самого правого листа до корня - это end()
+            if (position_ == node_->count) {
+                node_ = nullptr;
+                position_ = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator iterator_copy = *this;
+            ++(*this);
+            return iterator_copy;
+        }
+
+        Iterator& operator--() {
+            if (!node_) {
+                node_ = tree_->rightmost_;
+                position_ = node_->count - 1;
+                return *this;
+            }
+            if (!node_->leaf) {
+                node_ = Rightmost(static_cast<InternalNode*>(node_)->children[position_]);
+                position_ = node_->count - 1;
+                return *this;
+            }
+            while (position_ == 0 && node_->parent) {
+                position_ = node_->position;
+                node_ = node_->parent;
+            }
+            --position_;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator iterator_copy = *this;
+            --(*this);
+            return iterator_copy;
+        }
+
+        bool operator==(const Iterator&) const = default;
+
+        bool operator!=(const Iterator&) const = default;
+
+    private:
+        Iterator(const BTree* tree, LeafNode* node, size_t position): tree_(tree), node_(node), position_(position) {}
+
+        // дерево нужно только чтобы отступить от end(), у которого нет листа
+        const BTree* tree_ = nullptr;
+        LeafNode* node_ = nullptr;
+        size_t position_ = 0;
+    };
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using reference = Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    template<typename traversal_type = InOrder>
+    using iterator = Iterator;
+
+    template<typename traversal_type = InOrder>
+    using const_iterator = Iterator;
+
+    template<typename traversal_type = InOrder>
+    using reverse_iterator = std::reverse_iterator<Iterator>;
+
+    template<typename traversal_type = InOrder>
+    using const_reverse_iterator = std::reverse_iterator<Iterator>;
+
+    using LeafAlloc = std::allocator_traits<Allocator>::template rebind_alloc<LeafNode>;
+    using InternalAlloc = std::allocator_traits<Allocator>::template rebind_alloc<InternalNode>;
+    using LeafAllocTraits = std::allocator_traits<LeafAlloc>;
+
+    BTree(key_compare comparator = Compare()): comparator_(comparator) {}
+
+    template<typename Iter>
+    BTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        insert(iterator_start, iterator_finish);
+    }
+
+    BTree(std::initializer_list<value_type> initializer_list, Compare comparator = Compare()): comparator_(comparator) {
+        insert(initializer_list);
+    }
+
+    BTree(const BTree& other)
+        : leaf_alloc_(LeafAllocTraits::select_on_container_copy_construction(other.leaf_alloc_)),
+          internal_alloc_(leaf_alloc_),
+          comparator_(other.comparator_) {
+        CloneFrom(other);
+    }
+
+    BTree(BTree&& other) noexcept
+        : leaf_alloc_(std::move(other.leaf_alloc_)),
+          internal_alloc_(std::move(other.internal_alloc_)),
+          comparator_(other.comparator_) {
+        StealFrom(other);
+    }
+
+    ~BTree() {
+        clear();
+    }
+
+    BTree& operator=(const BTree& other) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        if constexpr (LeafAllocTraits::propagate_on_container_copy_assignment::value) {
+            leaf_alloc_ = other.leaf_alloc_;
+            internal_alloc_ = other.internal_alloc_;
+        }
+        comparator_ = other.comparator_;
+        CloneFrom(other);
+        return *this;
+    }
+
+    BTree& operator=(BTree&& other) noexcept(LeafAllocTraits::propagate_on_container_move_assignment::value || LeafAllocTraits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        comparator_ = other.comparator_;
+
+        if constexpr (LeafAllocTraits::propagate_on_container_move_assignment::value) {
+            leaf_alloc_ = std::move(other.leaf_alloc_);
+            internal_alloc_ = std::move(other.internal_alloc_);
+        } else if (!LeafAllocTraits::is_always_equal::value && leaf_alloc_ != other.leaf_alloc_) {
+            CloneFrom(other);
+            return *this;
+        }
+        StealFrom(other);
+        return *this;
+    }
+
+    BTree& operator=(std::initializer_list<value_type> initializer_list) {
+        clear();
+        insert(initializer_list);
+        return *this;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> begin() const requires std::is_same_v<traversal_type, InOrder> {
+        return leftmost_ ? iterator<traversal_type>(this, leftmost_, 0) : end<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> end() const requires std::is_same_v<traversal_type, InOrder> {
+        return iterator<traversal_type>(this, nullptr, 0);
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cbegin() const {
+        return begin<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cend() const {
+        return end<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rbegin() const {
+        return reverse_iterator<traversal_type>(end<traversal_type>());
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rend() const {
+        return reverse_iterator<traversal_type>(begin<traversal_type>());
+    }
+
+    template<typename traversal_type = InOrder>
+    const_reverse_iterator<traversal_type> rcbegin() const {
+        return rbegin<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    const_reverse_iterator<traversal_type> rcend() const {
+        return rend<traversal_type>();
+    }
+
+    size_type size() const {
+        return size_;
+    }
+
+    size_type max_size() const {
+        return std::numeric_limits<size_type>::max();
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    Compare value_comp() const {
+        return comparator_;
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(const Key& key) {
+        return InsertUnique(key, key);
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(Key&& key) {
+        return InsertUnique(key, std::move(key));
+    }
+
+    template<typename traversal_type = InOrder, typename... Args>
+    std::pair<iterator<traversal_type>, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        return InsertUnique(key, std::move(key));
+    }
+
+    template<typename traversal_type = InOrder, typename... Args>
+    std::pair<iterator<traversal_type>, bool> try_emplace(const Key& key, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            return InsertUnique(key, key);
+        } else {
+            return InsertUnique(key, std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename Iter>
+    void insert(Iter start_iterator, Iter finish_iterator) {
+        while (start_iterator != finish_iterator) {
+            insert(*start_iterator);
+            ++start_iterator;
+        }
+    }
+
+    void insert(std::initializer_list<value_type> initializer_list) {
+        insert(initializer_list.begin(), initializer_list.end());
+    }
+
+    size_type erase(const Key& key) {
+        Iterator target = find(key);
+        if (target == end()) {
+            return 0;
+        }
+        EraseAt(target.node_, target.position_);
+        return 1;
+    }
+
+    // ключи переезжают между узлами при перебалансировке, поэтому следующий элемент ищется заново по копии ключа
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(const_iterator<traversal_type> position) {
+        Key key = *position;
+        EraseAt(position.node_, position.position_);
+        return upper_bound(key);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(iterator<traversal_type> iterator_start, iterator<traversal_type> iterator_finish) {
+        if (iterator_start == begin() && iterator_finish == end()) {
+            clear();
+            return end();
+        }
+        if (iterator_finish == end()) {
+            while (iterator_start != end()) {
+                iterator_start = erase(iterator_start);
+            }
+            return end();
+        }
+        Key last = *iterator_finish;
+        while (comparator_(*iterator_start, last)) {
+            iterator_start = erase(iterator_start);
+        }
+        return iterator_start;
+    }
+
+    void clear() {
+        if (root_) {
+            DestroySubtree(root_);
+        }
+        root_ = nullptr;
+        leftmost_ = nullptr;
+        rightmost_ = nullptr;
+        size_ = 0;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> find(const Key& key) const {
+        LeafNode* node = root_;
+        while (node) {
+            size_t index = LowerIndex(node, key);
+            if (index < node->count && !comparator_(key, *node->key(index))) {
+                return iterator<traversal_type>(this, node, index);
+            }
+            node = node->leaf ? nullptr : static_cast<InternalNode*>(node)->children[index];
+        }
+        return end();
+    }
+
+    size_type count(const Key& key) const {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> lower_bound(const Key& key) const {
+        Iterator best = end();
+        LeafNode* node = root_;
+        while (node) {
+            size_t index = LowerIndex(node, key);
+            if (index < node->count) {
+                best = Iterator(this, node, index);
+                if (!comparator_(key, *node->key(index))) {
+                    break;
+                }
+            }
+            node = node->leaf ? nullptr : static_cast<InternalNode*>(node)->children[index];
+        }
+        return best;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> upper_bound(const Key& key) const {
+        Iterator best = end();
+        LeafNode* node = root_;
+        while (node) {
+            size_t index = UpperIndex(node, key);
+            if (index < node->count) {
+                best = Iterator(this, node, index);
+            }
+            node = node->leaf ? nullptr : static_cast<InternalNode*>(node)->children[index];
+        }
+        return best;
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, iterator<traversal_type>> equal_range(const Key& key) const {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    void swap(BTree& other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(leftmost_, other.leftmost_);
+        std::swap(rightmost_, other.rightmost_);
+        std::swap(size_, other.size_);
+        std::swap(comparator_, other.comparator_);
+        if constexpr (LeafAllocTraits::propagate_on_container_swap::value) {
+            std::swap(leaf_alloc_, other.leaf_alloc_);
+            std::swap(internal_alloc_, other.internal_alloc_);
+        }
+    }
+
+private:
+    static LeafNode* Leftmost(LeafNode* node) {
+        while (!node->leaf) {
+            node = static_cast<InternalNode*>(node)->children[0];
+        }
+        return node;
+    }
+
+    static LeafNode* Rightmost(LeafNode* node) {
+        while (!node->leaf) {
+            node = static_cast<InternalNode*>(node)->children[node->count];
+        }
+        return node;
+    }
+
+    static LeafNode*& Child(LeafNode* node, size_t index) {
+        return static_cast<InternalNode*>(node)->children[index];
+    }
+
+    size_t LowerIndex(const LeafNode* node, const Key& key) const {
+        size_t low = 0;
+        size_t high = node->count;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (comparator_(*node->key(middle), key)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    size_t UpperIndex(const LeafNode* node, const Key& key) const {
+        size_t low = 0;
+        size_t high = node->count;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (comparator_(key, *node->key(middle))) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        return low;
+    }
+
+    // ячейки ключей либо заняты, либо сырые: перенос конструирует ключ на новом месте и разрушает старый
+    static void MoveKeys(LeafNode* source, size_t from, LeafNode* target, size_t to, size_t count) {
+        if constexpr (std::is_trivially_copyable_v<Key>) {
+            if (count) {
+                std::memmove(target->key(to), source->key(from), count * sizeof(Key));
+            }
+        } else if (source != target || to < from) {
+            for (size_t index = 0; index < count; ++index) {
+                Relocate(source->key(from + index), target->key(to + index));
+            }
+        } else {
+            for (size_t index = count; index > 0; --index) {
+                Relocate(source->key(from + index - 1), target->key(to + index - 1));
+            }
+        }
+    }
+
+    static void Relocate(Key* from, Key* to) {
+        std::construct_at(to, std::move(*from));
+        std::destroy_at(from);
+    }
+
+    static void MoveChildren(LeafNode* source, size_t from, LeafNode* target, size_t to, size_t count) {
+        if (count) {
+            std::memmove(&Child(target, to), &Child(source, from), count * sizeof(LeafNode*));
+        }
+        Adopt(target, to, to + count);
+    }
+
+    static void Adopt(LeafNode* node, size_t from, size_t to) {
+        for (size_t index = from; index < to; ++index) {
+            Child(node, index)->parent = static_cast<InternalNode*>(node);
+            Child(node, index)->position = index;
+        }
+    }
+
+    LeafNode* NewNode(bool leaf) {
+        if (leaf) {
+            LeafNode* node = leaf_alloc_.allocate(1);
+            return std::construct_at(node);
+        }
+        InternalNode* node = internal_alloc_.allocate(1);
+        return std::construct_at(node);
+    }
+
+    void DeleteNode(LeafNode* node) {
+        std::destroy(node->key(0), node->key(node->count));
+        if (node->leaf) {
+            std::destroy_at(node);
+            leaf_alloc_.deallocate(node, 1);
+        } else {
+            std::destroy_at(static_cast<InternalNode*>(node));
+            internal_alloc_.deallocate(static_cast<InternalNode*>(node), 1);
+        }
+    }
+
+    // высота дерева логарифмическая по основанию kMinKeys, рекурсия неглубокая
+    void DestroySubtree(LeafNode* node) {
+        if (!node->leaf) {
+            for (size_t index = 0; index <= node->count; ++index) {
+                DestroySubtree(Child(node, index));
+            }
+        }
+        DeleteNode(node);
+    }
+
+    LeafNode* CloneSubtree(const LeafNode* source) {
+        LeafNode* node = NewNode(source->leaf);
+        for (; node->count < source->count; ++node->count) {
+            std::construct_at(node->key(node->count), *source->key(node->count));
+        }
+        if (!source->leaf) {
+            for (size_t index = 0; index <= source->count; ++index) {
+                Child(node, index) = CloneSubtree(Child(const_cast<LeafNode*>(source), index));
+            }
+            Adopt(node, 0, source->count + 1);
+        }
+        return node;
+    }
+
+    void CloneFrom(const BTree& other) {
+        if (!other.root_) {
+            return;
+        }
+        root_ = CloneSubtree(other.root_);
+        leftmost_ = Leftmost(root_);
+        rightmost_ = Rightmost(root_);
+        size_ = other.size_;
+    }
+
+    void StealFrom(BTree& other) {
+        root_ = std::exchange(other.root_, nullptr);
+        leftmost_ = std::exchange(other.leftmost_, nullptr);
+        rightmost_ = std::exchange(other.rightmost_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    template<typename... Args>
+    std::pair<Iterator, bool> InsertUnique(const Key& key, Args&&... args) {
+        if (!root_) {
+            root_ = leftmost_ = rightmost_ = NewNode(true);
+        }
+
+        LeafNode* node = root_;
+        size_t index;
+        while (true) {
+            index = LowerIndex(node, key);
+            if (index < node->count && !comparator_(key, *node->key(index))) {
+                return std::make_pair(Iterator(this, node, index), false);
+            }
+            if (node->leaf) {
+                break;
+            }
+            node = Child(node, index);
+        }
+
+        MakeRoom(node, index);
+        MoveKeys(node, index, node, index + 1, node->count - index);
+        std::construct_at(node->key(index), std::forward<Args>(args)...);
+        ++node->count;
+        ++size_;
+        return std::make_pair(Iterator(this, node, index), true);
+    }
+
+    // делит полный узел пополам, медиана уходит в родителя; node и index переводятся туда, куда попадет вставка
+    void MakeRoom(LeafNode*& node, size_t& index) {
+        if (node->count < kMaxKeys) {
+            return;
+        }
+        if (node == root_) {
+            LeafNode* root = NewNode(false);
+            Child(root, 0) = node;
+            Adopt(root, 0, 1);
+            root_ = root;
+        }
+        LeafNode* parent = node->parent;
+        size_t position = node->position;
+        MakeRoom(parent, position);
+        parent = node->parent;
+        position = node->position;
+
+        const size_t middle = kMaxKeys / 2;
+        LeafNode* sibling = NewNode(node->leaf);
+        MoveKeys(node, middle + 1, sibling, 0, kMaxKeys - middle - 1);
+        sibling->count = kMaxKeys - middle - 1;
+        if (!node->leaf) {
+            MoveChildren(node, middle + 1, sibling, 0, kMaxKeys - middle);
+        }
+
+        MoveKeys(parent, position, parent, position + 1, parent->count - position);
+        Relocate(node->key(middle), parent->key(position));
+        MoveChildren(parent, position + 1, parent, position + 2, parent->count - position);
+        Child(parent, position + 1) = sibling;
+        Adopt(parent, position + 1, position + 2);
+        ++parent->count;
+        node->count = middle;
+
+        if (node == rightmost_) {
+            rightmost_ = sibling;
+        }
+        if (index > middle) {
+            node = sibling;
+            index -= middle + 1;
+        }
+    }
+
+    // ключ из внутреннего узла заменяется предшественником из листа, дальше удаление всегда идет из листа
+    void EraseAt(LeafNode* node, size_t index) {
+        std::destroy_at(node->key(index));
+        if (node->leaf) {
+            MoveKeys(node, index + 1, node, index, node->count - index - 1);
+        } else {
+            LeafNode* leaf = Rightmost(Child(node, index));
+            Relocate(leaf->key(leaf->count - 1), node->key(index));
+            node = leaf;
+        }
+        --node->count;
+        --size_;
+        Rebalance(node);
+    }
+
+    void Rebalance(LeafNode* node) {
+        while (node != root_ && node->count < kMinKeys) {
+            LeafNode* parent = node->parent;
+            size_t position = node->position;
+            if (position > 0 && Child(parent, position - 1)->count > kMinKeys) {
+                RotateRight(parent, position - 1);
+                return;
+            }
+            if (position < parent->count && Child(parent, position + 1)->count > kMinKeys) {
+                RotateLeft(parent, position);
+                return;
+            }
+            Merge(parent, position > 0 ? position - 1 : position);
+            node = parent;
+        }
+
+        if (root_->count) {
+            return;
+        }
+        LeafNode* old_root = root_;
+        if (root_->leaf) {
+            root_ = leftmost_ = rightmost_ = nullptr;
+        } else {
+            root_ = Child(root_, 0);
+            root_->parent = nullptr;
+            root_->position = 0;
+        }
+        DeleteNode(old_root);
+    }
+
+    // левый сосед отдает последний ключ через разделитель separator родителя
+    static void RotateRight(LeafNode* parent, size_t separator) {
+        LeafNode* left = Child(parent, separator);
+        LeafNode* right = Child(parent, separator + 1);
+        MoveKeys(right, 0, right, 1, right->count);
+        Relocate(parent->key(separator), right->key(0));
+        Relocate(left->key(left->count - 1), parent->key(separator));
+        if (!right->leaf) {
+            MoveChildren(right, 0, right, 1, right->count + 1);
+            Child(right, 0) = Child(left, left->count);
+            Adopt(right, 0, 1);
+        }
+        --left->count;
+        ++right->count;
+    }
+
+    static void RotateLeft(LeafNode* parent, size_t separator) {
+        LeafNode* left = Child(parent, separator);
+        LeafNode* right = Child(parent, separator + 1);
+        Relocate(parent->key(separator), left->key(left->count));
+        Relocate(right->key(0), parent->key(separator));
+        MoveKeys(right, 1, right, 0, right->count - 1);
+        if (!left->leaf) {
+            Child(left, left->count + 1) = Child(right, 0);
+            Adopt(left, left->count + 1, left->count + 2);
+            MoveChildren(right, 1, right, 0, right->count);
+        }
+        ++left->count;
+        --right->count;
+    }
+
+    // сливает соседей вокруг разделителя separator в левого, правый узел освобождается
+    void Merge(LeafNode* parent, size_t separator) {
+        LeafNode* left = Child(parent, separator);
+        LeafNode* right = Child(parent, separator + 1);
+        Relocate(parent->key(separator), left->key(left->count));
+        MoveKeys(right, 0, left, left->count + 1, right->count);
+        if (!left->leaf) {
+            MoveChildren(right, 0, left, left->count + 1, right->count + 1);
+        }
+        left->count += right->count + 1;
+
+        MoveKeys(parent, separator + 1, parent, separator, parent->count - separator - 1);
+        MoveChildren(parent, separator + 2, parent, separator + 1, parent->count - separator - 1);
+        --parent->count;
+
+        if (right == rightmost_) {
+            rightmost_ = left;
+        }
+        right->count = 0;
+        DeleteNode(right);
+    }
+
+    LeafAlloc leaf_alloc_;
+    InternalAlloc internal_alloc_;
+
+    LeafNode* root_ = nullptr;
+    LeafNode* leftmost_ = nullptr;
+    LeafNode* rightmost_ = nullptr;
+    size_type size_ = 0;
+
+    Compare comparator_;
+};
+
+template<typename Key, typename Compare, typename Allocator>
+void swap(BTree<Key, Compare, Allocator>& first, BTree<Key, Compare, Allocator>& second) {
+    first.swap(second);
+}
+
+template<typename Key, typename Compare, typename Allocator>
+bool operator==(const BTree<Key, Compare, Allocator>& first, const BTree<Key, Compare, Allocator>& second) {
+    return first.size() == second.size() && std::equal(first.begin(), first.end(), second.begin());
+}
+
+template<typename Key, typename Compare, typename Allocator>
+bool operator!=(const BTree<Key, Compare, Allocator>& first, const BTree<Key, Compare, Allocator>& second) {
+    return !(first == second);
+}
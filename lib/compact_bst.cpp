@@ -0,0 +1,875 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bst.h"
+
+// scapegoat-дерево, ноды которого лежат в одном непрерывном массиве и ссылаются друг на друга 32-битными индексами;
+// ячейка 0 - фиктивная нода: ее left - корень, а индекс 0 в ссылке означает отсутствие ребенка.
+// Баланс поддерживается перестройкой поддеревьев, поэтому в ноде нет служебных полей кроме ссылок
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>, typename link_type = ParentLinks>
+class CompactBinarySearchTree {
+    static constexpr bool kParentLinks = std::is_same_v<link_type, ParentLinks>;
+
+public:
+    using index_type = uint32_t;
+
+private:
+    static constexpr index_type kNull = 0;
+    // у свободной ячейки right помечен, left - следующая свободная
+    static constexpr index_type kFreeMark = std::numeric_limits<index_type>::max();
+    // высота scapegoat-дерева не больше log_1.5(n) + 1, для 2^32 нод это 56
+    static constexpr size_t kMaxDepth = 64;
+
+    struct Slot: CompactLinks<link_type> {
+        alignas(Key) unsigned char storage[sizeof(Key)];
+
+        Key& key() {
+            return *std::launder(reinterpret_cast<Key*>(storage));
+        }
+
+        const Key& key() const {
+            return *std::launder(reinterpret_cast<const Key*>(storage));
+        }
+    };
+
+    class Iterator {
+        friend CompactBinarySearchTree;
+
+    public:
+        using pointer_type = const Key*;
+        using reference_type = const Key&;
+        using pointer = const Key*;
+        using reference = const Key&;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Key;
+        using key_type = Key;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        Iterator() = default;
+
+        reference operator*() const {
+            return tree_->slots_[index_].key();
+        }
+
+        pointer operator->() const {
+            return &tree_->slots_[index_].key();
+        }
+
+        Iterator& operator++() {
+            index_ = tree_->Next(index_);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator iterator_copy = *this;
+            ++(*this);
+            return iterator_copy;
+        }
+
+        Iterator& operator--() {
+            index_ = tree_->Previous(index_);
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator iterator_copy = *this;
+            --(*this);
+            return iterator_copy;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return index_ != other.index_;
+        }
+
+    private:
+        Iterator(const CompactBinarySearchTree* tree, index_type index): tree_(tree), index_(index) {}
+
+        const CompactBinarySearchTree* tree_ = nullptr;
+        index_type index_ = kNull;
+    };
+
+    using SlotAlloc = std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+    using AllocTraits = std::allocator_traits<SlotAlloc>;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using reference = Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    template<typename traversal_type = InOrder>
+    using iterator = Iterator;
+
+    template<typename traversal_type = InOrder>
+    using const_iterator = Iterator;
+
+    template<typename traversal_type = InOrder>
+    using reverse_iterator = std::reverse_iterator<Iterator>;
+
+    template<typename traversal_type = InOrder>
+    using const_reverse_iterator = std::reverse_iterator<Iterator>;
+
+    static constexpr size_t kSlotSize = sizeof(Slot);
+
+    CompactBinarySearchTree(key_compare comparator = Compare()): comparator_(comparator) {}
+
+    template<typename Iter>
+    CompactBinarySearchTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        insert(iterator_start, iterator_finish);
+    }
+
+    CompactBinarySearchTree(std::initializer_list<value_type> initializer_list, Compare comparator = Compare()): comparator_(comparator) {
+        insert(initializer_list);
+    }
+
+    CompactBinarySearchTree(const CompactBinarySearchTree& other)
+        : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)), comparator_(other.comparator_) {
+        CopySlotsFrom(other);
+    }
+
+    CompactBinarySearchTree(CompactBinarySearchTree&& other) noexcept: alloc_(std::move(other.alloc_)), comparator_(other.comparator_) {
+        StealFrom(other);
+    }
+
+    ~CompactBinarySearchTree() {
+        clear();
+        if (slots_) {
+            alloc_.deallocate(slots_, capacity_);
+        }
+    }
+
+    CompactBinarySearchTree& operator=(const CompactBinarySearchTree& other) {
+        if (this != &other) {
+            CompactBinarySearchTree copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    CompactBinarySearchTree& operator=(CompactBinarySearchTree&& other) noexcept {
+        if (this != &other) {
+            CompactBinarySearchTree moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> begin() const requires std::is_same_v<traversal_type, InOrder> {
+        return Iterator(this, begin_);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> end() const requires std::is_same_v<traversal_type, InOrder> {
+        return Iterator(this, kNull);
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cbegin() const {
+        return begin<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cend() const {
+        return end<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rbegin() const {
+        return reverse_iterator<traversal_type>(end<traversal_type>());
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rend() const {
+        return reverse_iterator<traversal_type>(begin<traversal_type>());
+    }
+
+    size_type size() const {
+        return size_;
+    }
+
+    // индекс kFreeMark занят пометкой свободной ячейки, индекс 0 - фиктивной нодой
+    size_type max_size() const {
+        return kFreeMark - 1;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    Compare value_comp() const {
+        return comparator_;
+    }
+
+    void reserve(size_type count) {
+        if (count + 1 > capacity_) {
+            Reallocate(count + 1);
+        }
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(const Key& key) {
+        return InsertUnique(key, key);
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, bool> insert(Key&& key) {
+        return InsertUnique(key, std::move(key));
+    }
+
+    template<typename traversal_type = InOrder, typename... Args>
+    std::pair<iterator<traversal_type>, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        return InsertUnique(key, std::move(key));
+    }
+
+    template<typename Iter>
+    void insert(Iter start_iterator, Iter finish_iterator) {
+        while (start_iterator != finish_iterator) {
+            insert(*start_iterator);
+            ++start_iterator;
+        }
+    }
+
+    void insert(std::initializer_list<value_type> initializer_list) {
+        insert(initializer_list.begin(), initializer_list.end());
+    }
+
+    size_type erase(const Key& key) {
+        index_type parent = kNull;
+        index_type node = Root();
+        while (node) {
+            if (comparator_(key, Key_(node))) {
+                parent = node;
+                node = slots_[node].left;
+            } else if (comparator_(Key_(node), key)) {
+                parent = node;
+                node = slots_[node].right;
+            } else {
+                EraseNode(node, parent);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(const_iterator<traversal_type> position) {
+        index_type next = Next(position.index_);
+        if constexpr (kParentLinks) {
+            EraseNode(position.index_, slots_[position.index_].parent);
+        } else {
+            erase(*position);
+        }
+        return Iterator(this, next);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> erase(iterator<traversal_type> iterator_start, iterator<traversal_type> iterator_finish) {
+        if (iterator_start == begin() && iterator_finish == end()) {
+            clear();
+            return end();
+        }
+        while (iterator_start != iterator_finish) {
+            iterator_start = erase(iterator_start);
+        }
+        return iterator_finish;
+    }
+
+    // освобождает ключи проходом по массиву, без обхода дерева; память массива остается за деревом
+    void clear() {
+        if (!slots_) {
+            return;
+        }
+        if constexpr (!std::is_trivially_destructible_v<Key>) {
+            for (index_type index = 1; index < used_; ++index) {
+                if (slots_[index].right != kFreeMark) {
+                    std::destroy_at(&slots_[index].key());
+                }
+            }
+        }
+        slots_[0] = Slot();
+        used_ = 1;
+        free_ = kNull;
+        size_ = 0;
+        max_size_ = 0;
+        begin_ = kNull;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> find(const Key& key) const {
+        index_type node = Root();
+        while (node) {
+            if (comparator_(key, Key_(node))) {
+                node = slots_[node].left;
+            } else if (comparator_(Key_(node), key)) {
+                node = slots_[node].right;
+            } else {
+                return Iterator(this, node);
+            }
+        }
+        return end();
+    }
+
+    size_type count(const Key& key) const {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> lower_bound(const Key& key) const {
+        index_type best = kNull;
+        for (index_type node = Root(); node;) {
+            if (comparator_(Key_(node), key)) {
+                node = slots_[node].right;
+            } else {
+                best = node;
+                node = slots_[node].left;
+            }
+        }
+        return Iterator(this, best);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> upper_bound(const Key& key) const {
+        return Iterator(this, Successor(key));
+    }
+
+    template<typename traversal_type = InOrder>
+    std::pair<iterator<traversal_type>, iterator<traversal_type>> equal_range(const Key& key) const {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    void swap(CompactBinarySearchTree& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        std::swap(comparator_, other.comparator_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(used_, other.used_);
+        std::swap(free_, other.free_);
+        std::swap(size_, other.size_);
+        std::swap(max_size_, other.max_size_);
+        std::swap(begin_, other.begin_);
+    }
+
+    // ссылки - индексы, поэтому массив ячеек можно записать как есть и прочитать по любому адресу.
+    // Заголовок пишется по полям, чтобы в поток не попадали байты выравнивания
+    void serialize(std::ostream& out) const requires std::is_trivially_copyable_v<Key> {
+        WriteField(out, static_cast<uint64_t>(kSlotSize));
+        WriteField(out, used_);
+        WriteField(out, free_);
+        WriteField(out, static_cast<uint64_t>(size_));
+        WriteField(out, static_cast<uint64_t>(max_size_));
+        WriteField(out, begin_);
+        if (used_ > 1) {
+            out.write(reinterpret_cast<const char*>(slots_), static_cast<std::streamsize>(used_ * sizeof(Slot)));
+        }
+    }
+
+    // при несовпадении формата, обрыве потока или несогласованных ссылках выставляет failbit и возвращает пустое дерево
+    static CompactBinarySearchTree deserialize(std::istream& in, key_compare comparator = Compare()) requires std::is_trivially_copyable_v<Key> {
+        CompactBinarySearchTree tree(comparator);
+        Header header;
+        if (!ReadField(in, header.slot_size) || !ReadField(in, header.used) || !ReadField(in, header.free) ||
+            !ReadField(in, header.size) || !ReadField(in, header.max_size) || !ReadField(in, header.begin) ||
+            header.slot_size != kSlotSize || header.used == 0 || header.size >= header.used ||
+            header.max_size < header.size || header.max_size >= header.used) {
+            in.setstate(std::ios::failbit);
+            return tree;
+        }
+        if (header.used == 1) {
+            if (header.free != kNull || header.begin != kNull) {
+                in.setstate(std::ios::failbit);
+            }
+            return tree;
+        }
+
+        // размер в заголовке еще не проверен, поэтому массив растет по мере чтения, а не выделяется сразу
+        for (size_t loaded = 0; loaded < header.used;) {
+            size_t target = std::min<size_t>(header.used, std::max<size_t>(2 * loaded, kLoadChunk));
+            tree.Reallocate(target);
+            if (!in.read(reinterpret_cast<char*>(tree.slots_ + loaded), static_cast<std::streamsize>((target - loaded) * sizeof(Slot)))) {
+                tree.slots_[0] = Slot();
+                tree.used_ = 1;
+                return tree;
+            }
+            loaded = target;
+            tree.used_ = static_cast<index_type>(loaded);
+        }
+        tree.free_ = header.free;
+        tree.size_ = header.size;
+        tree.max_size_ = header.max_size;
+        tree.begin_ = header.begin;
+        if (!tree.Consistent()) {
+            in.setstate(std::ios::failbit);
+            tree.slots_[0] = Slot();
+            tree.used_ = 1;
+            tree.free_ = kNull;
+            tree.size_ = 0;
+            tree.max_size_ = 0;
+            tree.begin_ = kNull;
+        }
+        return tree;
+    }
+
+private:
+    // сколько ячеек читается до первой проверки, что поток действительно их содержит
+    static constexpr size_t kLoadChunk = size_t(1) << 16;
+
+    struct Header {
+        uint64_t slot_size = 0;
+        index_type used = 0;
+        index_type free = 0;
+        uint64_t size = 0;
+        uint64_t max_size = 0;
+        index_type begin = 0;
+    };
+
+    template<typename T>
+    static void WriteField(std::ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    static bool ReadField(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    // проверяет прочитанный массив: каждая ссылка указывает на занятую ячейку внутри used_, ключи идут по возрастанию,
+    // высота помещается в kMaxDepth, а все остальные ячейки образуют список свободных
+    bool Consistent() const {
+        index_type stack[kMaxDepth];
+        size_t levels[kMaxDepth];
+        size_t depth = 0;
+        size_t level = 1;
+        size_type count = 0;
+        index_type previous = kNull;
+        index_type node = Root();
+        if (!ValidChild(kNull, node)) {
+            return false;
+        }
+        while (node || depth) {
+            for (; node; node = slots_[node].left, ++level) {
+                if (level > kMaxDepth || !ValidChild(node, slots_[node].left)) {
+                    return false;
+                }
+                stack[depth] = node;
+                levels[depth++] = level;
+            }
+            node = stack[--depth];
+            level = levels[depth] + 1;
+            if (previous ? !comparator_(Key_(previous), Key_(node)) : node != begin_) {
+                return false;
+            }
+            if (++count > size_ || !ValidChild(node, slots_[node].right)) {
+                return false;
+            }
+            previous = node;
+            node = slots_[node].right;
+        }
+        if (count != size_ || (!count && begin_ != kNull)) {
+            return false;
+        }
+
+        index_type slot = free_;
+        for (size_t rest = used_ - 1 - size_; rest; --rest) {
+            if (slot == kNull || slot >= used_ || slots_[slot].right != kFreeMark) {
+                return false;
+            }
+            slot = slots_[slot].left;
+        }
+        return slot == kNull;
+    }
+
+    bool ValidChild(index_type parent, index_type child) const {
+        if (child == kNull) {
+            return true;
+        }
+        if (child >= used_) {
+            return false;
+        }
+        if constexpr (kParentLinks) {
+            return slots_[child].parent == parent;
+        }
+        return true;
+    }
+
+    index_type Root() const {
+        return slots_ ? slots_[0].left : kNull;
+    }
+
+    const Key& Key_(index_type index) const {
+        return slots_[index].key();
+    }
+
+    index_type Leftmost(index_type node) const {
+        while (slots_[node].left) {
+            node = slots_[node].left;
+        }
+        return node;
+    }
+
+    index_type Rightmost(index_type node) const {
+        while (slots_[node].right) {
+            node = slots_[node].right;
+        }
+        return node;
+    }
+
+    // первый ключ, строго больший key
+    index_type Successor(const Key& key) const {
+        index_type best = kNull;
+        for (index_type node = Root(); node;) {
+            if (comparator_(key, Key_(node))) {
+                best = node;
+                node = slots_[node].left;
+            } else {
+                node = slots_[node].right;
+            }
+        }
+        return best;
+    }
+
+    index_type Predecessor(const Key& key) const {
+        index_type best = kNull;
+        for (index_type node = Root(); node;) {
+            if (comparator_(Key_(node), key)) {
+                best = node;
+                node = slots_[node].right;
+            } else {
+                node = slots_[node].left;
+            }
+        }
+        return best;
+    }
+
+    // без ссылок на родителя соседа по порядку ищем спуском от корня за O(log n)
+    index_type Next(index_type node) const {
+        if (slots_[node].right) {
+            return Leftmost(slots_[node].right);
+        }
+        if constexpr (kParentLinks) {
+            while (slots_[slots_[node].parent].left != node) {
+                node = slots_[node].parent;
+            }
+            return slots_[node].parent;
+        } else {
+            return Successor(Key_(node));
+        }
+    }
+
+    index_type Previous(index_type node) const {
+        if (node == kNull) {
+            return Rightmost(Root());
+        }
+        if (slots_[node].left) {
+            return Rightmost(slots_[node].left);
+        }
+        if constexpr (kParentLinks) {
+            while (slots_[slots_[node].parent].right != node) {
+                node = slots_[node].parent;
+            }
+            return slots_[node].parent;
+        } else {
+            return Predecessor(Key_(node));
+        }
+    }
+
+    void SetParent(index_type node, index_type parent) {
+        if constexpr (kParentLinks) {
+            if (node) {
+                slots_[node].parent = parent;
+            }
+        }
+    }
+
+    void ReplaceChild(index_type parent, index_type old_child, index_type new_child) {
+        if (parent == kNull || slots_[parent].left == old_child) {
+            slots_[parent].left = new_child;
+        } else {
+            slots_[parent].right = new_child;
+        }
+        SetParent(new_child, parent);
+    }
+
+    void Reallocate(size_t capacity) {
+        if (capacity > static_cast<size_t>(kFreeMark)) {
+            throw std::length_error("CompactBinarySearchTree: more than 2^32 - 2 nodes");
+        }
+        Slot* slots = alloc_.allocate(capacity);
+        if (slots_) {
+            RelocateSlots(slots_, slots);
+            alloc_.deallocate(slots_, capacity_);
+        } else {
+            std::construct_at(slots);
+            used_ = 1;
+        }
+        slots_ = slots;
+        capacity_ = static_cast<index_type>(capacity);
+    }
+
+    void RelocateSlots(Slot* source, Slot* target) {
+        if constexpr (std::is_trivially_copyable_v<Key>) {
+            std::memcpy(static_cast<void*>(target), source, used_ * sizeof(Slot));
+        } else {
+            for (index_type index = 0; index < used_; ++index) {
+                static_cast<CompactLinks<link_type>&>(target[index]) = source[index];
+                if (index != 0 && source[index].right != kFreeMark) {
+                    std::construct_at(&target[index].key(), std::move(source[index].key()));
+                    std::destroy_at(&source[index].key());
+                }
+            }
+        }
+    }
+
+    index_type AllocateSlot() {
+        if (free_) {
+            index_type index = free_;
+            free_ = slots_[index].left;
+            return index;
+        }
+        if (used_ >= capacity_) {
+            Reallocate(std::max<size_t>(16, 2 * static_cast<size_t>(capacity_)));
+        }
+        return used_++;
+    }
+
+    void FreeSlot(index_type index) {
+        std::destroy_at(&slots_[index].key());
+        slots_[index].left = free_;
+        slots_[index].right = kFreeMark;
+        free_ = index;
+    }
+
+    void CopySlotsFrom(const CompactBinarySearchTree& other) {
+        if (!other.slots_) {
+            return;
+        }
+        slots_ = alloc_.allocate(other.used_);
+        capacity_ = other.used_;
+        used_ = other.used_;
+        if constexpr (std::is_trivially_copyable_v<Key>) {
+            std::memcpy(static_cast<void*>(slots_), other.slots_, used_ * sizeof(Slot));
+        } else {
+            for (index_type index = 0; index < used_; ++index) {
+                static_cast<CompactLinks<link_type>&>(slots_[index]) = other.slots_[index];
+                if (index != 0 && other.slots_[index].right != kFreeMark) {
+                    std::construct_at(&slots_[index].key(), other.slots_[index].key());
+                }
+            }
+        }
+        free_ = other.free_;
+        size_ = other.size_;
+        max_size_ = other.max_size_;
+        begin_ = other.begin_;
+    }
+
+    void StealFrom(CompactBinarySearchTree& other) {
+        slots_ = std::exchange(other.slots_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        used_ = std::exchange(other.used_, 1);
+        free_ = std::exchange(other.free_, kNull);
+        size_ = std::exchange(other.size_, 0);
+        max_size_ = std::exchange(other.max_size_, 0);
+        begin_ = std::exchange(other.begin_, kNull);
+    }
+
+    template<typename... Args>
+    std::pair<Iterator, bool> InsertUnique(const Key& key, Args&&... args) {
+        index_type path[kMaxDepth];
+        size_t depth = 0;
+        bool is_left = true;
+        for (index_type node = Root(); node;) {
+            path[depth++] = node;
+            if (comparator_(key, Key_(node))) {
+                node = slots_[node].left;
+                is_left = true;
+            } else if (comparator_(Key_(node), key)) {
+                node = slots_[node].right;
+                is_left = false;
+            } else {
+                return std::make_pair(Iterator(this, node), false);
+            }
+        }
+
+        // массив может переехать, поэтому ссылки на ячейки берутся только после выделения
+        index_type node = AllocateSlot();
+        std::construct_at(&slots_[node].key(), std::forward<Args>(args)...);
+        slots_[node].left = kNull;
+        slots_[node].right = kNull;
+
+        index_type parent = depth ? path[depth - 1] : kNull;
+        if (is_left) {
+            slots_[parent].left = node;
+        } else {
+            slots_[parent].right = node;
+        }
+        SetParent(node, parent);
+        if (begin_ == kNull || (is_left && parent == begin_)) {
+            begin_ = node;
+        }
+        ++size_;
+        max_size_ = std::max(max_size_, size_);
+
+        if (depth > std::log(static_cast<double>(size_)) / std::log(1.5)) {
+            FixDeepInsert(path, depth, node);
+        }
+        return std::make_pair(Iterator(this, node), true);
+    }
+
+    // поднимается по пути вставки до первого предка, у которого ребенок тяжелее 2/3 поддерева
+    void FixDeepInsert(const index_type* path, size_t depth, index_type node) {
+        index_type child = node;
+        size_type child_size = 1;
+        while (depth > 0) {
+            index_type parent = path[--depth];
+            index_type sibling = slots_[parent].left == child ? slots_[parent].right : slots_[parent].left;
+            size_type parent_size = child_size + SubtreeSize(sibling) + 1;
+            if (3 * child_size > 2 * parent_size) {
+                Rebuild(parent, depth ? path[depth - 1] : kNull, parent_size);
+                return;
+            }
+            child = parent;
+            child_size = parent_size;
+        }
+    }
+
+    size_type SubtreeSize(index_type node) const {
+        if (!node) {
+            return 0;
+        }
+        return SubtreeSize(slots_[node].left) + SubtreeSize(slots_[node].right) + 1;
+    }
+
+    void EraseNode(index_type node, index_type parent) {
+        if (node == begin_) {
+            begin_ = Next(node);
+        }
+
+        index_type left = slots_[node].left;
+        index_type right = slots_[node].right;
+        if (!left || !right) {
+            ReplaceChild(parent, node, left ? left : right);
+        } else {
+            index_type successor_parent = node;
+            index_type successor = right;
+            while (slots_[successor].left) {
+                successor_parent = successor;
+                successor = slots_[successor].left;
+            }
+            if (successor_parent != node) {
+                slots_[successor_parent].left = slots_[successor].right;
+                SetParent(slots_[successor].right, successor_parent);
+                slots_[successor].right = right;
+                SetParent(right, successor);
+            }
+            slots_[successor].left = left;
+            SetParent(left, successor);
+            ReplaceChild(parent, node, successor);
+        }
+        FreeSlot(node);
+        --size_;
+
+        if (3 * size_ < 2 * max_size_) {
+            if (size_) {
+                Rebuild(Root(), kNull, size_);
+            }
+            max_size_ = size_;
+        }
+    }
+
+    // выпрямляет поддерево в список по правым ссылкам поворотами направо, затем собирает идеально сбалансированное
+    void Rebuild(index_type node, index_type parent, size_type count) {
+        bool is_left = parent == kNull || slots_[parent].left == node;
+        index_type head = kNull;
+        index_type tail = kNull;
+        while (node) {
+            index_type left = slots_[node].left;
+            if (left) {
+                slots_[node].left = slots_[left].right;
+                slots_[left].right = node;
+                node = left;
+            } else {
+                (tail ? slots_[tail].right : head) = node;
+                tail = node;
+                node = slots_[node].right;
+            }
+        }
+
+        index_type root = BuildBalanced(head, count);
+        (is_left ? slots_[parent].left : slots_[parent].right) = root;
+        SetParent(root, parent);
+    }
+
+    index_type BuildBalanced(index_type& head, size_type count) {
+        if (!count) {
+            return kNull;
+        }
+        size_type left_count = (count - 1) / 2;
+        index_type left = BuildBalanced(head, left_count);
+        index_type root = head;
+        head = slots_[head].right;
+        slots_[root].left = left;
+        SetParent(left, root);
+        index_type right = BuildBalanced(head, count - left_count - 1);
+        slots_[root].right = right;
+        SetParent(right, root);
+        return root;
+    }
+
+    [[no_unique_address]] SlotAlloc alloc_;
+    Compare comparator_;
+
+    Slot* slots_ = nullptr;
+    index_type capacity_ = 0;
+    index_type used_ = 1;
+    index_type free_ = kNull;
+    index_type begin_ = kNull;
+    size_type size_ = 0;
+    size_type max_size_ = 0;
+};
+
+template<typename Key, typename Compare, typename Allocator, typename link_type>
+void swap(CompactBinarySearchTree<Key, Compare, Allocator, link_type>& first, CompactBinarySearchTree<Key, Compare, Allocator, link_type>& second) noexcept {
+    first.swap(second);
+}
+
+template<typename Key, typename Compare, typename Allocator, typename link_type>
+bool operator==(const CompactBinarySearchTree<Key, Compare, Allocator, link_type>& first, const CompactBinarySearchTree<Key, Compare, Allocator, link_type>& second) {
+    return first.size() == second.size() && std::equal(first.begin(), first.end(), second.begin());
+}
+
+template<typename Key, typename Compare, typename Allocator, typename link_type>
+bool operator!=(const CompactBinarySearchTree<Key, Compare, Allocator, link_type>& first, const CompactBinarySearchTree<Key, Compare, Allocator, link_type>& second) {
+    return !(first == second);
+}
@@ -0,0 +1,650 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "epoch.cpp"
+
+// стек указателей, который живет в массиве на стеке вызова, а при переполнении переезжает в кучу с удвоением.
+// Пути спуска почти всегда короче kInline, но ослабленная балансировка их высоту не ограничивает
+template<typename T, size_t kInline>
+class InlineStack {
+public:
+    InlineStack() = default;
+    InlineStack(const InlineStack&) = delete;
+    InlineStack& operator=(const InlineStack&) = delete;
+
+    T& operator[](size_t index) {
+        return data_[index];
+    }
+
+    T* data() {
+        return data_;
+    }
+
+    void Put(size_t index, T value) {
+        if (index == capacity_) {
+            Grow();
+        }
+        data_[index] = value;
+    }
+
+private:
+    void Grow() {
+        auto bigger = std::make_unique<T[]>(capacity_ * 2);
+        std::copy(data_, data_ + capacity_, bigger.get());
+        heap_ = std::move(bigger);
+        data_ = heap_.get();
+        capacity_ *= 2;
+    }
+
+    T inline_[kInline];
+    std::unique_ptr<T[]> heap_;
+    T* data_ = inline_;
+    size_t capacity_ = kInline;
+};
+
+// AVL-дерево для многих писателей и любого числа читателей. Читатели не берут блокировок: ссылки на детей атомарны,
+// а писатели никогда не меняют связи ноды, которую может держать читатель, кроме публикации готового поддерева
+// одной записью. Поворот строит копии двух-трех нод и подменяет ими старое поддерево целиком; вырезанные ноды
+// освобождаются только после EpochDomain::synchronize, когда до них уже не дойдет ни один читатель.
+// Писатель спускается без блокировок, как читатель, затем берет замки только тех нод, чьи ссылки меняет, и проверяет,
+// что они все еще связаны так, как он видел. Вырезанная нода помечается obsolete и больше не меняется, поэтому живая
+// нода никогда не переезжает и ее интервал ключей только расширяется. Вставки и удаления в разных частях дерева
+// идут параллельно. Балансировка ослабленная: шаг, чей путь устарел, бросается - ответственность за высоты выше
+// переходит к писателю, который этот путь изменил.
+// Поиски возвращают копию ключа: после выхода из поиска ноду могут освободить. Аллокатор вызывается из разных потоков
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class ConcurrentBinarySearchTree {
+    // спинлок ноды; obsolete - нода вырезана из дерева, взять ее замок уже нельзя
+    class NodeLock {
+    public:
+        bool lock() {
+            while (true) {
+                uint32_t state = state_.load(std::memory_order_relaxed);
+                if (state & kObsolete) {
+                    return false;
+                }
+                if (state == 0 && state_.compare_exchange_weak(state, kLocked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        bool try_lock() {
+            uint32_t expected = 0;
+            return state_.compare_exchange_strong(expected, kLocked, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() {
+            state_.store(0, std::memory_order_release);
+        }
+
+        void unlock_obsolete() {
+            state_.store(kObsolete, std::memory_order_release);
+        }
+
+    private:
+        static constexpr uint32_t kLocked = 1;
+        static constexpr uint32_t kObsolete = 2;
+
+        std::atomic<uint32_t> state_ = 0;
+    };
+
+    struct Node {
+        template<typename... Args>
+        Node(Args&&... args): key(std::forward<Args>(args)...) {}
+
+        const Key key;
+        std::atomic<Node*> left = nullptr;
+        std::atomic<Node*> right = nullptr;
+        // ссылки и высоту меняет только владелец замка
+        std::atomic<int> height = 1;
+        NodeLock lock;
+        Node* next_retired = nullptr;
+    };
+
+    using NodeAlloc = std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using AllocTraits = std::allocator_traits<NodeAlloc>;
+
+    // высота AVL-дерева меньше 1.45 * log2(n + 2); пути длиннее, которые оставляет ослабленная балансировка,
+    // переезжают в кучу
+    static constexpr size_t kInlineHeight = 128;
+    using Path = InlineStack<Node*, kInlineHeight>;
+    // вырезанные ноды копятся пачкой, чтобы ожидание читателей делилось на много операций
+    static constexpr size_t kRetireBatch = 1024;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    ConcurrentBinarySearchTree(key_compare comparator = Compare()): comparator_(comparator) {}
+
+    template<typename Iter>
+    ConcurrentBinarySearchTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        for (; iterator_start != iterator_finish; ++iterator_start) {
+            insert(*iterator_start);
+        }
+    }
+
+    ConcurrentBinarySearchTree(std::initializer_list<value_type> initializer_list, key_compare comparator = Compare())
+        : ConcurrentBinarySearchTree(initializer_list.begin(), initializer_list.end(), comparator) {}
+
+    ConcurrentBinarySearchTree(const ConcurrentBinarySearchTree&) = delete;
+    ConcurrentBinarySearchTree& operator=(const ConcurrentBinarySearchTree&) = delete;
+
+    // к моменту разрушения других потоков быть не должно, поэтому ждать эпоху не нужно
+    ~ConcurrentBinarySearchTree() {
+        DestroySubtree(root_.load(std::memory_order_relaxed));
+        FreeRetired(retired_.load(std::memory_order_relaxed));
+    }
+
+    size_type size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    bool contains(const Key& key) const {
+        auto guard = domain_.pin();
+        return FindNode(key) != nullptr;
+    }
+
+    size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    std::optional<Key> find(const Key& key) const {
+        auto guard = domain_.pin();
+        Node* node = FindNode(key);
+        return node ? std::optional<Key>(node->key) : std::nullopt;
+    }
+
+    std::optional<Key> lower_bound(const Key& key) const {
+        auto guard = domain_.pin();
+        Node* best = nullptr;
+        for (Node* node = root_.load(std::memory_order_acquire); node;) {
+            if (comparator_(node->key, key)) {
+                node = node->right.load(std::memory_order_acquire);
+            } else {
+                best = node;
+                node = node->left.load(std::memory_order_acquire);
+            }
+        }
+        return best ? std::optional<Key>(best->key) : std::nullopt;
+    }
+
+    std::optional<Key> upper_bound(const Key& key) const {
+        auto guard = domain_.pin();
+        Node* best = nullptr;
+        for (Node* node = root_.load(std::memory_order_acquire); node;) {
+            if (comparator_(key, node->key)) {
+                best = node;
+                node = node->left.load(std::memory_order_acquire);
+            } else {
+                node = node->right.load(std::memory_order_acquire);
+            }
+        }
+        return best ? std::optional<Key>(best->key) : std::nullopt;
+    }
+
+    // обход по возрастанию без блокировок; изменения, идущие параллельно, могут быть видны частично,
+    // а удаляемый ключ с двумя детьми - ненадолго дважды
+    template<typename Function>
+    void for_each(Function function) const {
+        auto guard = domain_.pin();
+        Path stack;
+        size_t depth = 0;
+        Node* node = root_.load(std::memory_order_acquire);
+        while (node || depth) {
+            while (node) {
+                stack.Put(depth++, node);
+                node = node->left.load(std::memory_order_acquire);
+            }
+            node = stack[--depth];
+            function(node->key);
+            node = node->right.load(std::memory_order_acquire);
+        }
+    }
+
+    bool insert(const Key& key) {
+        bool inserted = InsertUnique(key);
+        ReclaimIfNeeded();
+        return inserted;
+    }
+
+    bool insert(Key&& key) {
+        bool inserted = InsertUnique(std::move(key));
+        ReclaimIfNeeded();
+        return inserted;
+    }
+
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        bool inserted = InsertUnique(std::forward<Args>(args)...);
+        ReclaimIfNeeded();
+        return inserted;
+    }
+
+    size_type erase(const Key& key) {
+        size_type erased = EraseUnique(key);
+        ReclaimIfNeeded();
+        return erased;
+    }
+
+    // ноды, в которые успели вставить параллельные писатели, уходят вместе с деревом
+    void clear() {
+        {
+            auto guard = domain_.pin();
+            root_lock_.lock();
+            Node* pending = root_.exchange(nullptr, std::memory_order_acq_rel);
+            root_lock_.unlock();
+
+            // замок снимается только с пометкой obsolete, так что под уже пройденной нодой дерево больше не меняется
+            size_type removed = 0;
+            if (pending) {
+                pending->next_retired = nullptr;
+            }
+            while (pending) {
+                Node* node = pending;
+                pending = node->next_retired;
+                node->lock.lock();
+                for (Node* child: {node->left.load(std::memory_order_relaxed), node->right.load(std::memory_order_relaxed)}) {
+                    if (child) {
+                        child->next_retired = pending;
+                        pending = child;
+                    }
+                }
+                node->lock.unlock_obsolete();
+                Retire(node);
+                ++removed;
+            }
+            size_.fetch_sub(removed, std::memory_order_relaxed);
+        }
+        ReclaimIfNeeded();
+    }
+
+private:
+    Node* FindNode(const Key& key) const {
+        Node* node = root_.load(std::memory_order_acquire);
+        while (node) {
+            if (comparator_(key, node->key)) {
+                node = node->left.load(std::memory_order_acquire);
+            } else if (comparator_(node->key, key)) {
+                node = node->right.load(std::memory_order_acquire);
+            } else {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    NodeLock& LockOf(Node* parent) {
+        return parent ? parent->lock : root_lock_;
+    }
+
+    // ссылка parent на child, если child все еще его ребенок; parent == nullptr - корень
+    std::atomic<Node*>* ChildLink(Node* parent, Node* child) {
+        if (!parent) {
+            return root_.load(std::memory_order_relaxed) == child ? &root_ : nullptr;
+        }
+        if (parent->left.load(std::memory_order_relaxed) == child) {
+            return &parent->left;
+        }
+        return parent->right.load(std::memory_order_relaxed) == child ? &parent->right : nullptr;
+    }
+
+    template<typename... Args>
+    bool InsertUnique(Args&&... args) {
+        auto guard = domain_.pin();
+        Node* fresh = NewNode(std::forward<Args>(args)...);
+        const Key& key = fresh->key;
+        Path path;
+        while (true) {
+            size_t depth = 0;
+            Node* parent = nullptr;
+            std::atomic<Node*>* link = &root_;
+            for (Node* node = link->load(std::memory_order_acquire); node; node = link->load(std::memory_order_acquire)) {
+                if (comparator_(key, node->key)) {
+                    link = &node->left;
+                } else if (comparator_(node->key, key)) {
+                    link = &node->right;
+                } else {
+                    FreeNode(fresh);
+                    return false;
+                }
+                parent = node;
+                path.Put(depth++, node);
+            }
+
+            NodeLock& parent_lock = LockOf(parent);
+            if (!parent_lock.lock()) {
+                continue;
+            }
+            if (link->load(std::memory_order_relaxed) != nullptr) {
+                parent_lock.unlock();
+                continue;
+            }
+            // нода полностью построена до публикации, release-запись делает ее видимой читателям целиком
+            link->store(fresh, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            parent_lock.unlock();
+
+            Rebalance(path.data(), depth);
+            return true;
+        }
+    }
+
+    size_type EraseUnique(const Key& key) {
+        auto guard = domain_.pin();
+        Path path;
+        while (true) {
+            size_t depth = 0;
+            Node* parent = nullptr;
+            Node* node = root_.load(std::memory_order_acquire);
+            while (node) {
+                bool less = comparator_(key, node->key);
+                if (!less && !comparator_(node->key, key)) {
+                    break;
+                }
+                parent = node;
+                path.Put(depth++, node);
+                node = (less ? node->left : node->right).load(std::memory_order_acquire);
+            }
+            if (!node) {
+                return 0;
+            }
+
+            NodeLock& parent_lock = LockOf(parent);
+            if (!parent_lock.lock()) {
+                continue;
+            }
+            std::atomic<Node*>* link = ChildLink(parent, node);
+            if (!link || !node->lock.try_lock()) {
+                parent_lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            Node* left = node->left.load(std::memory_order_relaxed);
+            Node* right = node->right.load(std::memory_order_relaxed);
+            if (!left || !right) {
+                link->store(left ? left : right, std::memory_order_release);
+                size_.fetch_sub(1, std::memory_order_relaxed);
+                node->lock.unlock_obsolete();
+                parent_lock.unlock();
+                Retire(node);
+                Rebalance(path.data(), depth);
+                return 1;
+            }
+
+            // на место node встает копия преемника, затем сам преемник вырезается; в промежутке ключ преемника
+            // есть в дереве дважды, и поиск находит верхнюю копию
+            size_t replaced = depth;
+            path.Put(replaced, node);
+            size_t successor_depth = depth + 1;
+            Node* successor_parent = node;
+            Node* successor = right;
+            while (Node* next = successor->left.load(std::memory_order_acquire)) {
+                successor_parent = successor;
+                path.Put(successor_depth++, successor);
+                successor = next;
+            }
+            bool direct = successor_parent == node;
+            if (!direct && !successor_parent->lock.try_lock()) {
+                node->lock.unlock();
+                parent_lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            // пустая левая ссылка под замком значит, что между node и successor ключей нет
+            bool valid = (direct || successor_parent->left.load(std::memory_order_relaxed) == successor) && successor->lock.try_lock();
+            if (valid && successor->left.load(std::memory_order_relaxed) != nullptr) {
+                successor->lock.unlock();
+                valid = false;
+            }
+            if (!valid) {
+                if (!direct) {
+                    successor_parent->lock.unlock();
+                }
+                node->lock.unlock();
+                parent_lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            Node* successor_right = successor->right.load(std::memory_order_relaxed);
+            Node* copy = NewNode(successor->key);
+            copy->left.store(left, std::memory_order_relaxed);
+            copy->right.store(direct ? successor_right : right, std::memory_order_relaxed);
+            copy->height.store(node->height.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            link->store(copy, std::memory_order_release);
+            if (!direct) {
+                successor_parent->left.store(successor_right, std::memory_order_release);
+            }
+            size_.fetch_sub(1, std::memory_order_relaxed);
+
+            successor->lock.unlock_obsolete();
+            if (!direct) {
+                successor_parent->lock.unlock();
+            }
+            node->lock.unlock_obsolete();
+            parent_lock.unlock();
+            Retire(node);
+            Retire(successor);
+
+            path[replaced] = copy;
+            Rebalance(path.data(), successor_depth);
+            return 1;
+        }
+    }
+
+    static int Height(const Node* node) {
+        return node ? node->height.load(std::memory_order_relaxed) : 0;
+    }
+
+    static int ComputeHeight(const Node* node) {
+        return 1 + std::max(Height(node->left.load(std::memory_order_relaxed)), Height(node->right.load(std::memory_order_relaxed)));
+    }
+
+    // поднимается по пути от нижней ноды; выше ноды, чья высота не изменилась, баланс не нарушен.
+    // Если нода уже не ребенок своего предка на пути, ее заменил другой писатель, и выше пойдет он
+    void Rebalance(Node** path, size_t depth) {
+        while (depth > 0) {
+            Node* node = path[depth - 1];
+            Node* parent = depth > 1 ? path[depth - 2] : nullptr;
+            NodeLock& parent_lock = LockOf(parent);
+            if (!parent_lock.lock()) {
+                return;
+            }
+            std::atomic<Node*>* link = ChildLink(parent, node);
+            if (!link) {
+                parent_lock.unlock();
+                return;
+            }
+            // нода связана с запертым предком и потому жива, замок может быть только занят
+            if (!node->lock.try_lock()) {
+                parent_lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            int old_height = node->height.load(std::memory_order_relaxed);
+            Node* replaced[3];
+            size_t replaced_count = 0;
+            Node* balanced = Balance(node, replaced, replaced_count);
+            if (!balanced) {
+                node->lock.unlock();
+                parent_lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            if (balanced != node) {
+                link->store(balanced, std::memory_order_release);
+                for (size_t i = 0; i < replaced_count; ++i) {
+                    replaced[i]->lock.unlock_obsolete();
+                }
+            } else {
+                node->lock.unlock();
+            }
+            parent_lock.unlock();
+            for (size_t i = 0; i < replaced_count; ++i) {
+                Retire(replaced[i]);
+            }
+
+            if (balanced->height.load(std::memory_order_relaxed) == old_height) {
+                return;
+            }
+            --depth;
+        }
+    }
+
+    // node заперт. Возвращает корень поддерева после балансировки: node или новую копию, тогда замененные ноды
+    // заперты и перечислены в replaced. nullptr - замок ребенка занят
+    Node* Balance(Node* node, Node** replaced, size_t& replaced_count) {
+        Node* left = node->left.load(std::memory_order_relaxed);
+        Node* right = node->right.load(std::memory_order_relaxed);
+        int balance = Height(left) - Height(right);
+        if (balance >= -1 && balance <= 1) {
+            node->height.store(ComputeHeight(node), std::memory_order_relaxed);
+            return node;
+        }
+
+        bool child_is_left = balance > 1;
+        Node* child = child_is_left ? left : right;
+        if (!child->lock.try_lock()) {
+            return nullptr;
+        }
+        Node* outer = (child_is_left ? child->left : child->right).load(std::memory_order_relaxed);
+        Node* inner = (child_is_left ? child->right : child->left).load(std::memory_order_relaxed);
+        replaced[replaced_count++] = node;
+        replaced[replaced_count++] = child;
+        if (Height(outer) >= Height(inner)) {
+            return RotateSingle(node, child, child_is_left);
+        }
+        if (!inner->lock.try_lock()) {
+            child->lock.unlock();
+            replaced_count = 0;
+            return nullptr;
+        }
+        replaced[replaced_count++] = inner;
+        return RotateDouble(node, child, inner, child_is_left);
+    }
+
+    // поворот копированием: читатель внутри старого поддерева видит его прежним, новое публикует вызывающий
+    Node* RotateSingle(Node* node, Node* child, bool child_is_left) {
+        Node* new_node = CopyWithChildren(node,
+            child_is_left ? child->right.load(std::memory_order_relaxed) : node->left.load(std::memory_order_relaxed),
+            child_is_left ? node->right.load(std::memory_order_relaxed) : child->left.load(std::memory_order_relaxed));
+        return CopyWithChildren(child,
+            child_is_left ? child->left.load(std::memory_order_relaxed) : new_node,
+            child_is_left ? new_node : child->right.load(std::memory_order_relaxed));
+    }
+
+    Node* RotateDouble(Node* node, Node* child, Node* inner, bool child_is_left) {
+        Node* inner_left = inner->left.load(std::memory_order_relaxed);
+        Node* inner_right = inner->right.load(std::memory_order_relaxed);
+        if (child_is_left) {
+            Node* new_child = CopyWithChildren(child, child->left.load(std::memory_order_relaxed), inner_left);
+            Node* new_node = CopyWithChildren(node, inner_right, node->right.load(std::memory_order_relaxed));
+            return CopyWithChildren(inner, new_child, new_node);
+        }
+        Node* new_node = CopyWithChildren(node, node->left.load(std::memory_order_relaxed), inner_left);
+        Node* new_child = CopyWithChildren(child, inner_right, child->right.load(std::memory_order_relaxed));
+        return CopyWithChildren(inner, new_node, new_child);
+    }
+
+    Node* CopyWithChildren(const Node* source, Node* left, Node* right) {
+        Node* node = NewNode(source->key);
+        node->left.store(left, std::memory_order_relaxed);
+        node->right.store(right, std::memory_order_relaxed);
+        node->height.store(ComputeHeight(node), std::memory_order_relaxed);
+        return node;
+    }
+
+    template<typename... Args>
+    Node* NewNode(Args&&... args) {
+        Node* node = alloc_.allocate(1);
+        AllocTraits::construct(alloc_, node, std::forward<Args>(args)...);
+        return node;
+    }
+
+    void FreeNode(Node* node) {
+        AllocTraits::destroy(alloc_, node);
+        alloc_.deallocate(node, 1);
+    }
+
+    // вызывается только после того, как нода отцеплена от дерева
+    void Retire(Node* node) {
+        node->next_retired = retired_.load(std::memory_order_relaxed);
+        while (!retired_.compare_exchange_weak(node->next_retired, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        retired_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // вызывается вне guard: synchronize ждет и собственного читателя. Пачку забирает один писатель, остальные идут дальше
+    void ReclaimIfNeeded() {
+        if (retired_count_.load(std::memory_order_relaxed) < kRetireBatch || reclaiming_.test_and_set(std::memory_order_acquire)) {
+            return;
+        }
+        Node* retired = retired_.exchange(nullptr, std::memory_order_acquire);
+        domain_.synchronize();
+        retired_count_.fetch_sub(FreeRetired(retired), std::memory_order_relaxed);
+        reclaiming_.clear(std::memory_order_release);
+    }
+
+    size_type FreeRetired(Node* node) {
+        size_type count = 0;
+        for (; node; ++count) {
+            FreeNode(std::exchange(node, node->next_retired));
+        }
+        return count;
+    }
+
+    void DestroySubtree(Node* root) {
+        // next_retired переиспользуется как стек еще не освобожденных поддеревьев
+        Node* pending = root;
+        while (pending) {
+            Node* node = pending;
+            pending = node->next_retired;
+            if (Node* left = node->left.load(std::memory_order_relaxed)) {
+                left->next_retired = pending;
+                pending = left;
+            }
+            if (Node* right = node->right.load(std::memory_order_relaxed)) {
+                right->next_retired = pending;
+                pending = right;
+            }
+            FreeNode(node);
+        }
+    }
+
+    std::atomic<Node*> root_ = nullptr;
+    NodeLock root_lock_;
+    std::atomic<size_type> size_ = 0;
+    mutable EpochDomain<> domain_;
+
+    std::atomic<Node*> retired_ = nullptr;
+    std::atomic<size_type> retired_count_ = 0;
+    std::atomic_flag reclaiming_;
+
+    [[no_unique_address]] NodeAlloc alloc_;
+    Compare comparator_;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// BeforeRegister вызывается между чтением эпохи и записью в счетчик
+struct NoEpochHooks {
+    static void BeforeRegister() {}
+};
+
+// эпохи для отложенного освобождения нод, которые могут читать без блокировок.
+// Читатель на время операции отмечается в счетчике своего слота для четности текущей эпохи; synchronize переключает
+// эпоху и ждет, пока счетчики прежней четности обнулятся. После этого ни один читатель не держит ноду,
+// отцепленную до вызова synchronize, и ее можно освобождать.
+// Hooks - точки вмешательства для тестов; пустые по умолчанию, они не оставляют в pin() ни одной инструкции
+template<typename Hooks = NoEpochHooks>
+class EpochDomain {
+public:
+    // потоки раскладываются по слотам по кругу; общий слот только добавляет соперничества за кеш-линию
+    static constexpr size_t kSlots = 64;
+
+    class Guard {
+        friend EpochDomain;
+
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            counter_->fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        // между чтением эпохи и записью в счетчик synchronize может успеть переключить эпоху и не увидеть нас;
+        // тогда счетчик устарел, и следующий synchronize ждал бы только другую четность. Поэтому после забора
+        // эпоха перечитывается, и при расхождении читатель перерегистрируется
+        explicit Guard(EpochDomain& domain) {
+            Slot& slot = domain.slots_[ThreadSlot()];
+            while (true) {
+                uint64_t epoch = domain.epoch_.load(std::memory_order_acquire);
+                Hooks::BeforeRegister();
+                counter_ = &slot.readers[epoch & 1];
+                counter_->fetch_add(1, std::memory_order_relaxed);
+                // парный забор в synchronize: либо писатель увидит этот счетчик, либо мы увидим новую эпоху
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (domain.epoch_.load(std::memory_order_relaxed) == epoch) {
+                    return;
+                }
+                counter_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        std::atomic<int64_t>* counter_;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    Guard pin() {
+        return Guard(*this);
+    }
+
+    // возвращается, когда закончились все операции чтения, начатые до вызова. Вызывающий не должен держать Guard.
+    // Вызовы упорядочены: второе переключение эпохи до конца первого ожидания пропустило бы старых читателей
+    void synchronize() {
+        std::lock_guard lock(synchronize_mutex_);
+        size_t parity = epoch_.fetch_add(1, std::memory_order_acq_rel) & 1;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Slot& slot: slots_) {
+            while (slot.readers[parity].load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<int64_t> readers[2] = {0, 0};
+    };
+
+    static size_t ThreadSlot() {
+        static std::atomic<size_t> next_slot = 0;
+        thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kSlots;
+        return slot;
+    }
+
+    std::atomic<uint64_t> epoch_ = 0;
+    Slot slots_[kSlots];
+    std::mutex synchronize_mutex_;
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "bst.h"
+
+// неизменяемый снимок дерева: ключи лежат одним массивом в порядке обхода в ширину (раскладка Эйтцингера),
+// дети ячейки k - ячейки 2k и 2k + 1, ячейка 0 не используется
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FrozenBinarySearchTree {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    class Iterator {
+        friend FrozenBinarySearchTree;
+
+    public:
+        using pointer = const Key*;
+        using reference = const Key&;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Key;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        Iterator() = default;
+
+        reference operator*() const {
+            return keys_[index_];
+        }
+
+        pointer operator->() const {
+            return &keys_[index_];
+        }
+
+        // in-order по неявному дереву: в самый левый узел правого поддерева, иначе вверх, пока идем из правого ребенка
+        Iterator& operator++() {
+            if (2 * index_ + 1 <= size_) {
+                index_ = 2 * index_ + 1;
+                while (2 * index_ <= size_) {
+                    index_ *= 2;
+                }
+            } else {
+                index_ >>= std::countr_one(index_) + 1;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator iterator_copy = *this;
+            ++(*this);
+            return iterator_copy;
+        }
+
+        Iterator& operator--() {
+            if (index_ == 0) {
+                index_ = Rightmost(1, size_);
+            } else if (2 * index_ <= size_) {
+                index_ = Rightmost(2 * index_, size_);
+            } else {
+                index_ >>= std::countr_zero(index_) + 1;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator iterator_copy = *this;
+            --(*this);
+            return iterator_copy;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return index_ != other.index_;
+        }
+
+    private:
+        Iterator(const Key* keys, size_type size, size_type index): keys_(keys), size_(size), index_(index) {}
+
+        static size_type Rightmost(size_type index, size_type size) {
+            while (2 * index + 1 <= size) {
+                index = 2 * index + 1;
+            }
+            return index;
+        }
+
+        const Key* keys_ = nullptr;
+        size_type size_ = 0;
+        size_type index_ = 0;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    FrozenBinarySearchTree(key_compare comparator = Compare(), const Allocator& alloc = Allocator()): alloc_(alloc), comparator_(comparator) {}
+
+    // диапазон должен быть строго возрастающим по comparator
+    template<typename Iter>
+    FrozenBinarySearchTree(AssumeSorted, Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare(), const Allocator& alloc = Allocator())
+        : FrozenBinarySearchTree(assume_sorted, iterator_start, static_cast<size_type>(std::distance(iterator_start, iterator_finish)), comparator, alloc) {}
+
+    template<typename Iter>
+    FrozenBinarySearchTree(AssumeSorted, Iter iterator_start, size_type count, key_compare comparator = Compare(), const Allocator& alloc = Allocator())
+        : alloc_(alloc), comparator_(comparator) {
+        Allocate(count);
+        for (Iterator position = begin(); position != end(); ++position, ++iterator_start) {
+            AllocTraits::construct(alloc_, keys_ + position.index_, *iterator_start);
+        }
+    }
+
+    FrozenBinarySearchTree(const FrozenBinarySearchTree& other)
+        : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)), comparator_(other.comparator_) {
+        Allocate(other.size_);
+        for (size_type index = 1; index <= size_; ++index) {
+            AllocTraits::construct(alloc_, keys_ + index, other.keys_[index]);
+        }
+    }
+
+    FrozenBinarySearchTree(FrozenBinarySearchTree&& other) noexcept
+        : alloc_(std::move(other.alloc_)), comparator_(other.comparator_), keys_(other.keys_), size_(other.size_) {
+        other.keys_ = nullptr;
+        other.size_ = 0;
+    }
+
+    FrozenBinarySearchTree& operator=(FrozenBinarySearchTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~FrozenBinarySearchTree() {
+        if (!keys_) {
+            return;
+        }
+        for (size_type index = 1; index <= size_; ++index) {
+            AllocTraits::destroy(alloc_, keys_ + index);
+        }
+        alloc_.deallocate(keys_, size_ + 1);
+    }
+
+    iterator begin() const {
+        return ++end();
+    }
+
+    iterator end() const {
+        return iterator(keys_, size_, 0);
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    size_type size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    Compare value_comp() const {
+        return comparator_;
+    }
+
+    iterator lower_bound(const Key& key) const {
+        return iterator(keys_, size_, Descend(key, [this](const Key& node_key, const Key& search_key) {
+            return comparator_(node_key, search_key);
+        }));
+    }
+
+    iterator upper_bound(const Key& key) const {
+        return iterator(keys_, size_, Descend(key, [this](const Key& node_key, const Key& search_key) {
+            return !comparator_(search_key, node_key);
+        }));
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& key) const {
+        iterator lower = lower_bound(key);
+        if (lower == end() || comparator_(key, *lower)) {
+            return std::make_pair(lower, lower);
+        }
+        return std::make_pair(lower, std::next(lower));
+    }
+
+    iterator find(const Key& key) const {
+        iterator lower = lower_bound(key);
+        if (lower == end() || comparator_(key, *lower)) {
+            return end();
+        }
+        return lower;
+    }
+
+    size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    void swap(FrozenBinarySearchTree& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        std::swap(comparator_, other.comparator_);
+        std::swap(keys_, other.keys_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    // потомки на 4 уровня ниже ячейки k лежат подряд с 16k, их подкачиваем заранее
+    static constexpr size_type kPrefetchDistance = 16;
+
+    void Allocate(size_type count) {
+        if (!count) {
+            return;
+        }
+        keys_ = alloc_.allocate(count + 1);
+        size_ = count;
+    }
+
+    // спуск без ветвлений: go_right решает только, куда сдвинуть индекс; после выхода за массив
+    // снимаем хвост поворотов направо и одну последнюю единицу, остается последний поворот налево
+    template<typename GoRight>
+    size_type Descend(const Key& key, GoRight go_right) const {
+        size_type index = 1;
+        while (index <= size_) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(keys_ + kPrefetchDistance * index);
+#endif
+            index = 2 * index + go_right(keys_[index], key);
+        }
+        return index >> (std::countr_one(index) + 1);
+    }
+
+    Allocator alloc_;
+    Compare comparator_;
+    Key* keys_ = nullptr;
+    size_type size_ = 0;
+};
+
+template<typename Key, typename Compare, typename Allocator>
+void swap(FrozenBinarySearchTree<Key, Compare, Allocator>& first, FrozenBinarySearchTree<Key, Compare, Allocator>& second) noexcept {
+    first.swap(second);
+}
@@ -0,0 +1,552 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "bst.h"
+
+// неизменяемое AVL-дерево: insert и erase не трогают текущую версию, а возвращают новую, которая копирует только путь
+// от корня до измененной ноды (O(log n) нод) и делит с прежней все остальное. Копия версии - снимок за O(1).
+// Ноды живут, пока на них ссылается хотя бы одна версия или нода; счетчик ссылок атомарный, так что версии можно
+// отдавать читателям в другие потоки, а писатель продолжает порождать новые. Аллокатор при этом тоже зовется
+// из разных потоков. Родительских ссылок у общих нод быть не может, поэтому итератор хранит путь от корня
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class PersistentBinarySearchTree {
+    struct Node {
+        template<typename... Args>
+        Node(const Node* left, const Node* right, Args&&... args): left(left), right(right), key(std::forward<Args>(args)...) {
+            height = 1 + std::max(Height(left), Height(right));
+        }
+
+        const Node* left;
+        const Node* right;
+        int height;
+        mutable std::atomic<size_t> references = 1;
+        const Key key;
+    };
+
+    using NodeAlloc = std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using AllocTraits = std::allocator_traits<NodeAlloc>;
+
+    // высота AVL-дерева меньше 1.45 * log2(n + 2)
+    static constexpr size_t kMaxHeight = 96;
+
+    template<typename traversal_type = InOrder>
+    class Iterator {
+        friend PersistentBinarySearchTree;
+
+    public:
+        using pointer = const Key*;
+        using reference = const Key&;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Key;
+        using key_type = Key;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        Iterator() = default;
+
+        // копируется только занятая часть пути
+        Iterator(const Iterator& other): root_(other.root_), depth_(other.depth_) {
+            std::copy_n(other.path_, depth_, path_);
+        }
+
+        Iterator& operator=(const Iterator& other) {
+            root_ = other.root_;
+            depth_ = other.depth_;
+            std::copy_n(other.path_, depth_, path_);
+            return *this;
+        }
+
+        reference operator*() const {
+            return Top()->key;
+        }
+
+        pointer operator->() const {
+            return &Top()->key;
+        }
+
+        Iterator& operator++() {
+            Increment(traversal_type{});
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator iterator_copy = *this;
+            ++(*this);
+            return iterator_copy;
+        }
+
+        Iterator& operator--() {
+            Decrement(traversal_type{});
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator iterator_copy = *this;
+            --(*this);
+            return iterator_copy;
+        }
+
+        // путь до ноды единственный, поэтому итераторы одной версии равны, когда равны их ноды
+        bool operator==(const Iterator& other) const {
+            return (depth_ ? Top() : nullptr) == (other.depth_ ? other.Top() : nullptr);
+        }
+
+    private:
+        explicit Iterator(const Node* root): root_(root) {}
+
+        const Node* Top() const {
+            return path_[depth_ - 1];
+        }
+
+        void Push(const Node* node) {
+            path_[depth_++] = node;
+        }
+
+        const Node* Pop() {
+            return path_[--depth_];
+        }
+
+        void PushLeftmost(const Node* node) {
+            for (; node; node = node->left) {
+                Push(node);
+            }
+        }
+
+        void PushRightmost(const Node* node) {
+            for (; node; node = node->right) {
+                Push(node);
+            }
+        }
+
+        // последний в pre-order ключ поддерева
+        void PushPreOrderLast(const Node* node) {
+            for (; node; node = node->right ? node->right : node->left) {
+                Push(node);
+            }
+        }
+
+        // первый в post-order ключ поддерева
+        void PushPostOrderFirst(const Node* node) {
+            for (; node; node = node->left ? node->left : node->right) {
+                Push(node);
+            }
+        }
+
+        void Increment(InOrder) {
+            if (Top()->right) {
+                PushLeftmost(Top()->right);
+                return;
+            }
+            const Node* child = Pop();
+            while (depth_ && Top()->right == child) {
+                child = Pop();
+            }
+        }
+
+        void Increment(PreOrder) {
+            if (Top()->left || Top()->right) {
+                Push(Top()->left ? Top()->left : Top()->right);
+                return;
+            }
+            const Node* child = Pop();
+            while (depth_ && !(Top()->left == child && Top()->right)) {
+                child = Pop();
+            }
+            if (depth_) {
+                Push(Top()->right);
+            }
+        }
+
+        void Increment(PostOrder) {
+            const Node* child = Pop();
+            if (depth_ && Top()->left == child && Top()->right) {
+                PushPostOrderFirst(Top()->right);
+            }
+        }
+
+        void Decrement(InOrder) {
+            if (!depth_) {
+                PushRightmost(root_);
+                return;
+            }
+            if (Top()->left) {
+                PushRightmost(Top()->left);
+                return;
+            }
+            const Node* child = Pop();
+            while (depth_ && Top()->left == child) {
+                child = Pop();
+            }
+        }
+
+        void Decrement(PreOrder) {
+            if (!depth_) {
+                PushPreOrderLast(root_);
+                return;
+            }
+            const Node* child = Pop();
+            if (depth_ && Top()->right == child && Top()->left) {
+                PushPreOrderLast(Top()->left);
+            }
+        }
+
+        void Decrement(PostOrder) {
+            if (!depth_) {
+                Push(root_);
+                return;
+            }
+            if (Top()->right || Top()->left) {
+                Push(Top()->right ? Top()->right : Top()->left);
+                return;
+            }
+            const Node* child = Pop();
+            while (depth_ && !(Top()->right == child && Top()->left)) {
+                child = Pop();
+            }
+            if (depth_) {
+                Push(Top()->left);
+            }
+        }
+
+        const Node* root_ = nullptr;
+        size_t depth_ = 0;
+        const Node* path_[kMaxHeight];
+    };
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    template<typename traversal_type>
+    using iterator = Iterator<traversal_type>;
+
+    template<typename traversal_type>
+    using const_iterator = Iterator<traversal_type>;
+
+    template<typename traversal_type>
+    using reverse_iterator = std::reverse_iterator<iterator<traversal_type>>;
+
+    template<typename traversal_type>
+    using const_reverse_iterator = std::reverse_iterator<const_iterator<traversal_type>>;
+
+    PersistentBinarySearchTree(key_compare comparator = Compare()): comparator_(comparator) {}
+
+    template<typename Iter>
+    PersistentBinarySearchTree(Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare()): comparator_(comparator) {
+        for (; iterator_start != iterator_finish; ++iterator_start) {
+            *this = insert(*iterator_start);
+        }
+    }
+
+    PersistentBinarySearchTree(std::initializer_list<value_type> initializer_list, Compare comparator = Compare())
+        : PersistentBinarySearchTree(initializer_list.begin(), initializer_list.end(), comparator) {}
+
+    // снимок: версия делит все ноды с other
+    PersistentBinarySearchTree(const PersistentBinarySearchTree& other)
+        : root_(Share(other.root_)), size_(other.size_), alloc_(other.alloc_), comparator_(other.comparator_) {}
+
+    PersistentBinarySearchTree(PersistentBinarySearchTree&& other) noexcept
+        : root_(std::exchange(other.root_, nullptr)), size_(std::exchange(other.size_, 0)), alloc_(other.alloc_), comparator_(other.comparator_) {}
+
+    PersistentBinarySearchTree& operator=(PersistentBinarySearchTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~PersistentBinarySearchTree() {
+        Release(root_);
+    }
+
+    PersistentBinarySearchTree snapshot() const {
+        return *this;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> begin() const {
+        Iterator<traversal_type> result(root_);
+        if (root_) {
+            Begin(result, traversal_type{});
+        }
+        return result;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> end() const {
+        return Iterator<traversal_type>(root_);
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cbegin() const {
+        return begin<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    const_iterator<traversal_type> cend() const {
+        return end<traversal_type>();
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rbegin() const {
+        return reverse_iterator<traversal_type>(end<traversal_type>());
+    }
+
+    template<typename traversal_type = InOrder>
+    reverse_iterator<traversal_type> rend() const {
+        return reverse_iterator<traversal_type>(begin<traversal_type>());
+    }
+
+    size_type size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    Compare value_comp() const {
+        return comparator_;
+    }
+
+    // новая версия с key; если key уже есть, возвращается эта же версия
+    [[nodiscard]] PersistentBinarySearchTree insert(const Key& key) const {
+        bool inserted = false;
+        const Node* root = Insert(root_, key, inserted);
+        return inserted ? PersistentBinarySearchTree(*this, root, size_ + 1) : *this;
+    }
+
+    [[nodiscard]] PersistentBinarySearchTree erase(const Key& key) const {
+        bool erased = false;
+        const Node* root = Erase(root_, key, erased);
+        return erased ? PersistentBinarySearchTree(*this, root, size_ - 1) : *this;
+    }
+
+    [[nodiscard]] PersistentBinarySearchTree clear() const {
+        return PersistentBinarySearchTree(comparator_);
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> find(const Key& key) const {
+        Iterator<traversal_type> result(root_);
+        for (const Node* node = root_; node;) {
+            result.Push(node);
+            if (comparator_(key, node->key)) {
+                node = node->left;
+            } else if (comparator_(node->key, key)) {
+                node = node->right;
+            } else {
+                return result;
+            }
+        }
+        return end<traversal_type>();
+    }
+
+    size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    bool contains(const Key& key) const {
+        for (const Node* node = root_; node;) {
+            if (comparator_(key, node->key)) {
+                node = node->left;
+            } else if (comparator_(node->key, key)) {
+                node = node->right;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // путь до ответа - префикс пути спуска, поэтому итератор обрезается до глубины последнего подходящего предка
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> lower_bound(const Key& key) const {
+        Iterator<traversal_type> result(root_);
+        size_t bound_depth = 0;
+        for (const Node* node = root_; node;) {
+            result.Push(node);
+            if (comparator_(node->key, key)) {
+                node = node->right;
+            } else {
+                bound_depth = result.depth_;
+                node = node->left;
+            }
+        }
+        result.depth_ = bound_depth;
+        return result;
+    }
+
+    template<typename traversal_type = InOrder>
+    iterator<traversal_type> upper_bound(const Key& key) const {
+        Iterator<traversal_type> result(root_);
+        size_t bound_depth = 0;
+        for (const Node* node = root_; node;) {
+            result.Push(node);
+            if (comparator_(key, node->key)) {
+                bound_depth = result.depth_;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        result.depth_ = bound_depth;
+        return result;
+    }
+
+    // версии, порожденные друг от друга, совпадают без обхода, пока делят корень
+    bool operator==(const PersistentBinarySearchTree& other) const {
+        return size_ == other.size_ && (root_ == other.root_ || std::equal(begin(), end(), other.begin(), other.end()));
+    }
+
+    void swap(PersistentBinarySearchTree& other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(size_, other.size_);
+        std::swap(alloc_, other.alloc_);
+        std::swap(comparator_, other.comparator_);
+    }
+
+private:
+    PersistentBinarySearchTree(const PersistentBinarySearchTree& base, const Node* root, size_type size)
+        : root_(root), size_(size), alloc_(base.alloc_), comparator_(base.comparator_) {}
+
+    template<typename traversal_type>
+    static void Begin(Iterator<traversal_type>& iterator, InOrder) {
+        iterator.PushLeftmost(iterator.root_);
+    }
+
+    template<typename traversal_type>
+    static void Begin(Iterator<traversal_type>& iterator, PreOrder) {
+        iterator.Push(iterator.root_);
+    }
+
+    template<typename traversal_type>
+    static void Begin(Iterator<traversal_type>& iterator, PostOrder) {
+        iterator.PushPostOrderFirst(iterator.root_);
+    }
+
+    static int Height(const Node* node) {
+        return node ? node->height : 0;
+    }
+
+    static const Node* Share(const Node* node) {
+        if (node) {
+            node->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    // освобождает ноду, когда уходит последняя ссылка; глубина рекурсии не больше высоты дерева
+    void Release(const Node* node) const {
+        if (!node || node->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        Release(node->left);
+        Release(node->right);
+        Node* mutable_node = const_cast<Node*>(node);
+        AllocTraits::destroy(alloc_, mutable_node);
+        alloc_.deallocate(mutable_node, 1);
+    }
+
+    // забирает ссылки на left и right
+    const Node* Make(const Node* left, const Key& key, const Node* right) const {
+        Node* node = alloc_.allocate(1);
+        AllocTraits::construct(alloc_, node, left, right, key);
+        return node;
+    }
+
+    // собирает (left, key, right) с AVL-балансом; разобранные при повороте ноды копируются, их дети делятся
+    const Node* Balance(const Node* left, const Key& key, const Node* right) const {
+        if (Height(left) > Height(right) + 1) {
+            const Node* result;
+            if (Height(left->left) >= Height(left->right)) {
+                result = Make(Share(left->left), left->key, Make(Share(left->right), key, right));
+            } else {
+                const Node* inner = left->right;
+                result = Make(Make(Share(left->left), left->key, Share(inner->left)), inner->key, Make(Share(inner->right), key, right));
+            }
+            Release(left);
+            return result;
+        }
+        if (Height(right) > Height(left) + 1) {
+            const Node* result;
+            if (Height(right->right) >= Height(right->left)) {
+                result = Make(Make(left, key, Share(right->left)), right->key, Share(right->right));
+            } else {
+                const Node* inner = right->left;
+                result = Make(Make(left, key, Share(inner->left)), inner->key, Make(Share(inner->right), right->key, Share(right->right)));
+            }
+            Release(right);
+            return result;
+        }
+        return Make(left, key, right);
+    }
+
+    // рекурсия по пути копирования; при отсутствии изменений возвращает nullptr и ничего не выделяет
+    const Node* Insert(const Node* node, const Key& key, bool& inserted) const {
+        if (!node) {
+            inserted = true;
+            return Make(nullptr, key, nullptr);
+        }
+        if (comparator_(key, node->key)) {
+            const Node* left = Insert(node->left, key, inserted);
+            return inserted ? Balance(left, node->key, Share(node->right)) : nullptr;
+        }
+        if (comparator_(node->key, key)) {
+            const Node* right = Insert(node->right, key, inserted);
+            return inserted ? Balance(Share(node->left), node->key, right) : nullptr;
+        }
+        return nullptr;
+    }
+
+    const Node* Erase(const Node* node, const Key& key, bool& erased) const {
+        if (!node) {
+            return nullptr;
+        }
+        if (comparator_(key, node->key)) {
+            const Node* left = Erase(node->left, key, erased);
+            return erased ? Balance(left, node->key, Share(node->right)) : nullptr;
+        }
+        if (comparator_(node->key, key)) {
+            const Node* right = Erase(node->right, key, erased);
+            return erased ? Balance(Share(node->left), node->key, right) : nullptr;
+        }
+
+        erased = true;
+        if (!node->left || !node->right) {
+            return Share(node->left ? node->left : node->right);
+        }
+        // ноду заменяет копия минимума правого поддерева; старый минимум жив, пока жива текущая версия
+        const Node* successor = node->right;
+        while (successor->left) {
+            successor = successor->left;
+        }
+        return Balance(Share(node->left), successor->key, EraseMinimum(node->right));
+    }
+
+    const Node* EraseMinimum(const Node* node) const {
+        if (!node->left) {
+            return Share(node->right);
+        }
+        return Balance(EraseMinimum(node->left), node->key, Share(node->right));
+    }
+
+    const Node* root_ = nullptr;
+    size_type size_ = 0;
+    [[no_unique_address]] mutable NodeAlloc alloc_;
+    Compare comparator_;
+};
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// раздает блоки одного размера из непрерывных чанков, освобожденные блоки уходят в free list
+class NodePool {
+public:
+    NodePool(size_t block_size, size_t alignment)
+        : alignment_(std::max(alignment, alignof(Chunk))),
+          block_size_(RoundUp(std::max(block_size, sizeof(FreeBlock)), alignment_)),
+          header_size_(RoundUp(sizeof(Chunk), alignment_)) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        release();
+    }
+
+    void* allocate() {
+        // зарезервированные блоки выдаются раньше free list, иначе резерв перемешался бы со старыми дырами
+        if (reserved_) {
+            --reserved_;
+        } else if (free_list_) {
+            FreeBlock* block = free_list_;
+            free_list_ = block->next;
+            return block;
+        } else if (position_ == end_) {
+            if (spare_position_ != spare_end_) {
+                position_ = std::exchange(spare_position_, nullptr);
+                end_ = std::exchange(spare_end_, nullptr);
+            } else {
+                AddChunk(blocks_per_chunk_);
+                blocks_per_chunk_ = std::min(blocks_per_chunk_ * 2, kMaxBlocksPerChunk);
+            }
+        }
+        void* block = position_;
+        position_ += block_size_;
+        return block;
+    }
+
+    void deallocate(void* block) {
+        free_list_ = ::new(block) FreeBlock{free_list_};
+    }
+
+    // следующие count вызовов allocate нарезают блоки подряд из одного чанка, даже если в free list что-то есть.
+    // Хвост текущего чанка откладывается и идет в дело, когда новый чанк кончится; из двух хвостов остается больший
+    void reserve(size_t count) {
+        if (static_cast<size_t>(end_ - position_) < count * block_size_) {
+            if (end_ - position_ > spare_end_ - spare_position_) {
+                spare_position_ = position_;
+                spare_end_ = end_;
+            }
+            AddChunk(std::max(count, blocks_per_chunk_));
+        }
+        reserved_ = count;
+    }
+
+    void release() {
+        while (chunks_) {
+            Chunk* next = chunks_->next;
+            ::operator delete(chunks_, std::align_val_t(alignment_));
+            chunks_ = next;
+        }
+        free_list_ = nullptr;
+        position_ = nullptr;
+        end_ = nullptr;
+        spare_position_ = nullptr;
+        spare_end_ = nullptr;
+        reserved_ = 0;
+        blocks_per_chunk_ = kMinBlocksPerChunk;
+    }
+
+private:
+    struct Chunk {
+        Chunk* next;
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t kMinBlocksPerChunk = 64;
+    static constexpr size_t kMaxBlocksPerChunk = 1 << 16;
+
+    static size_t RoundUp(size_t size, size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void AddChunk(size_t block_count) {
+        void* memory = ::operator new(header_size_ + block_count * block_size_, std::align_val_t(alignment_));
+        chunks_ = ::new(memory) Chunk{chunks_};
+        position_ = static_cast<char*>(memory) + header_size_;
+        end_ = position_ + block_count * block_size_;
+    }
+
+    size_t alignment_;
+    size_t block_size_;
+    size_t header_size_;
+    size_t blocks_per_chunk_ = kMinBlocksPerChunk;
+
+    Chunk* chunks_ = nullptr;
+    char* position_ = nullptr;
+    char* end_ = nullptr;
+    char* spare_position_ = nullptr;
+    char* spare_end_ = nullptr;
+    size_t reserved_ = 0;
+    FreeBlock* free_list_ = nullptr;
+};
+
+// пулы одного аллокатора и всех его rebind-копий, по одному на пару (размер блока, выравнивание).
+// Типов узлов у контейнера считанные единицы, поэтому хватает списка
+class NodePoolGroup {
+public:
+    NodePoolGroup() = default;
+
+    NodePoolGroup(const NodePoolGroup&) = delete;
+    NodePoolGroup& operator=(const NodePoolGroup&) = delete;
+
+    NodePool& get(size_t block_size, size_t alignment) {
+        for (Entry* entry = entries_.get(); entry; entry = entry->next.get()) {
+            if (entry->block_size == block_size && entry->alignment == alignment) {
+                return entry->pool;
+            }
+        }
+        entries_ = std::make_unique<Entry>(block_size, alignment, std::move(entries_));
+        return entries_->pool;
+    }
+
+    void release() {
+        for (Entry* entry = entries_.get(); entry; entry = entry->next.get()) {
+            entry->pool.release();
+        }
+    }
+
+private:
+    struct Entry {
+        Entry(size_t block_size, size_t alignment, std::unique_ptr<Entry> next)
+            : block_size(block_size), alignment(alignment), pool(block_size, alignment), next(std::move(next)) {}
+
+        size_t block_size;
+        size_t alignment;
+        NodePool pool;
+        std::unique_ptr<Entry> next;
+    };
+
+    std::unique_ptr<Entry> entries_;
+};
+
+// одиночные allocate(1) идут в NodePool, общий для копий аллокатора, остальные - в глобальную кучу.
+// rebind-копии делят с исходным аллокатором группу пулов, так что PoolAllocator<T>(PoolAllocator<U>(a)) == a
+template<typename T>
+class PoolAllocator {
+    template<typename U>
+    friend class PoolAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    PoolAllocator(): PoolAllocator(std::make_shared<NodePoolGroup>()) {}
+
+    // перемещение аллокатора обязано оставлять источник равным себе, поэтому оно копирует
+    PoolAllocator(const PoolAllocator&) = default;
+
+    PoolAllocator& operator=(const PoolAllocator&) = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other): PoolAllocator(other.group_) {}
+
+    T* allocate(size_t count) {
+        if (count != 1) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        return static_cast<T*>(pool_->allocate());
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        if (count != 1) {
+            ::operator delete(pointer, std::align_val_t(alignof(T)));
+            return;
+        }
+        pool_->deallocate(pointer);
+    }
+
+    void reserve(size_t count) {
+        pool_->reserve(count);
+    }
+
+    // arena-режим: отдает все чанки разом, если пулами больше никто не пользуется, включая rebind-копии
+    bool release() {
+        if (group_.use_count() != 1) {
+            return false;
+        }
+        group_->release();
+        return true;
+    }
+
+    PoolAllocator select_on_container_copy_construction() const {
+        return PoolAllocator();
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return group_ == other.group_;
+    }
+
+private:
+    explicit PoolAllocator(std::shared_ptr<NodePoolGroup> group)
+        : group_(std::move(group)), pool_(&group_->get(sizeof(T), alignof(T))) {}
+
+    std::shared_ptr<NodePoolGroup> group_;
+    NodePool* pool_;
+};
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "bst.cpp"
+
+// множество, разложенное по N независимым BinarySearchTree со своими замками и аллокаторами. Шард i хранит ключи
+// из [boundary(i - 1), boundary(i)), так что поиск идет в один шард, а обход по шардам подряд дает общий порядок.
+// Границы двигает фоновый поток, когда размеры шардов расходятся; без известных границ все ключи живут в шарде 0.
+// Вместо границ можно задать свой splitter, он должен быть монотонным; тогда границы не двигаются.
+// Операции над ключами потокобезопасны; итераторы, как у std::set, требуют отсутствия параллельных писателей,
+// а for_each обходит шарды под их замками
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class ShardedBinarySearchTree {
+    using Tree = BinarySearchTree<Key, Compare, Allocator>;
+    using TreeIterator = Tree::template const_iterator<InOrder>;
+
+    struct alignas(64) Shard {
+        Tree tree;
+        mutable std::shared_mutex mutex;
+    };
+
+    static constexpr std::chrono::milliseconds kRebalancePeriod {100};
+    // фоновая перебалансировка начинается, когда самый большой шард больше среднего в kSkewFactor раз
+    static constexpr size_t kSkewFactor = 2;
+    static constexpr size_t kMinRebalanceSize = 1024;
+
+    class Iterator {
+        friend ShardedBinarySearchTree;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+
+        Iterator() = default;
+
+        reference operator*() const {
+            return *position_;
+        }
+
+        pointer operator->() const {
+            return &*position_;
+        }
+
+        Iterator& operator++() {
+            ++position_;
+            SkipEmptyShards();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        Iterator& operator--() {
+            while (shard_ > 0 && position_ == owner_->shards_[shard_].tree.begin()) {
+                position_ = owner_->shards_[--shard_].tree.end();
+            }
+            --position_;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator result = *this;
+            --*this;
+            return result;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return shard_ == other.shard_ && position_ == other.position_;
+        }
+
+    private:
+        Iterator(const ShardedBinarySearchTree* owner, size_t shard, TreeIterator position): owner_(owner), shard_(shard), position_(position) {
+            SkipEmptyShards();
+        }
+
+        // end() шарда, кроме последнего, не позиция: итератор переходит к началу следующего
+        void SkipEmptyShards() {
+            while (shard_ + 1 < owner_->shard_count_ && position_ == owner_->shards_[shard_].tree.end()) {
+                position_ = owner_->shards_[++shard_].tree.begin();
+            }
+        }
+
+        const ShardedBinarySearchTree* owner_ = nullptr;
+        size_t shard_ = 0;
+        TreeIterator position_;
+    };
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using Splitter = std::function<size_t(const Key&)>;
+
+    static constexpr size_t kDefaultShardCount = 16;
+
+    explicit ShardedBinarySearchTree(size_t shard_count = kDefaultShardCount, key_compare comparator = Compare())
+        : ShardedBinarySearchTree(shard_count, Splitter(), comparator) {
+        if (shard_count_ > 1) {
+            rebalancer_ = std::jthread([this](std::stop_token stop) { RebalanceInBackground(stop); });
+        }
+    }
+
+    ShardedBinarySearchTree(size_t shard_count, Splitter splitter, key_compare comparator = Compare())
+        : shard_count_(std::max<size_t>(shard_count, 1)),
+          shards_(std::make_unique<Shard[]>(shard_count_)),
+          boundaries_(std::make_unique<std::optional<Key>[]>(shard_count_ - 1)),
+          splitter_(std::move(splitter)),
+          comparator_(comparator) {
+        for (size_t index = 0; index < shard_count_; ++index) {
+            shards_[index].tree = Tree(comparator_);
+        }
+    }
+
+    ShardedBinarySearchTree(const ShardedBinarySearchTree&) = delete;
+    ShardedBinarySearchTree& operator=(const ShardedBinarySearchTree&) = delete;
+
+    iterator begin() const {
+        return Iterator(this, 0, shards_[0].tree.begin());
+    }
+
+    iterator end() const {
+        return Iterator(this, shard_count_ - 1, shards_[shard_count_ - 1].tree.end());
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    size_type size() const {
+        size_type result = 0;
+        for (size_t index = 0; index < shard_count_; ++index) {
+            result += shard_size(index);
+        }
+        return result;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t shard_count() const {
+        return shard_count_;
+    }
+
+    size_type shard_size(size_t index) const {
+        std::shared_lock lock(shards_[index].mutex);
+        return shards_[index].tree.size();
+    }
+
+    Compare key_comp() const {
+        return comparator_;
+    }
+
+    bool insert(const Key& key) {
+        std::unique_lock<std::shared_mutex> lock;
+        return shards_[LockRoute(key, lock)].tree.insert(key).second;
+    }
+
+    bool insert(Key&& key) {
+        std::unique_lock<std::shared_mutex> lock;
+        Tree& tree = shards_[LockRoute(key, lock)].tree;
+        return tree.insert(std::move(key)).second;
+    }
+
+    template<typename Iter>
+    void insert(Iter iterator_start, Iter iterator_finish) {
+        for (; iterator_start != iterator_finish; ++iterator_start) {
+            insert(*iterator_start);
+        }
+    }
+
+    size_type erase(const Key& key) {
+        std::unique_lock<std::shared_mutex> lock;
+        return shards_[LockRoute(key, lock)].tree.erase(key);
+    }
+
+    void clear() {
+        for (size_t index = 0; index < shard_count_; ++index) {
+            std::unique_lock lock(shards_[index].mutex);
+            shards_[index].tree.clear();
+        }
+    }
+
+    bool contains(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock;
+        return shards_[LockRoute(key, lock)].tree.contains(key);
+    }
+
+    size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    // результаты - копии ключей: после снятия замка шарда его ноды могут измениться
+    std::optional<Key> find(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock;
+        const Tree& tree = shards_[LockRoute(key, lock)].tree;
+        auto it = tree.find(key);
+        return it != tree.end() ? std::optional<Key>(*it) : std::nullopt;
+    }
+
+    std::optional<Key> lower_bound(const Key& key) const {
+        return Bound<false>(key);
+    }
+
+    std::optional<Key> upper_bound(const Key& key) const {
+        return Bound<true>(key);
+    }
+
+    // обход по возрастанию; шарды проходятся по очереди под своими замками, ключи между ними в это время не переезжают
+    template<typename Function>
+    void for_each(Function function) const {
+        std::lock_guard rebalance_lock(rebalance_mutex_);
+        for (size_t index = 0; index < shard_count_; ++index) {
+            std::shared_lock lock(shards_[index].mutex);
+            for (const Key& key: shards_[index].tree) {
+                function(key);
+            }
+        }
+    }
+
+    // выставляет границы по квантилям всех ключей и переносит ключи между шардами. Шарды, чьи границы не меняются,
+    // не блокируются; остальные блокируются группами соседей, которые обмениваются ключами только между собой
+    void rebalance() {
+        if (splitter_ || shard_count_ == 1) {
+            return;
+        }
+        std::lock_guard rebalance_lock(rebalance_mutex_);
+        std::unique_ptr<std::optional<Key>[]> target = Quantiles();
+
+        for (size_t first = 0; first + 1 < shard_count_; ++first) {
+            if (SameBoundary(target[first], boundaries_[first])) {
+                continue;
+            }
+            size_t last = first + 1;
+            while (last + 1 < shard_count_ && !SameBoundary(target[last], boundaries_[last])) {
+                ++last;
+            }
+
+            // пока держится layout_mutex_, новых маршрутов нет, а уже проложенные успели взять замки шардов
+            std::unique_lock layout_lock(layout_mutex_);
+            for (size_t index = first; index <= last; ++index) {
+                shards_[index].mutex.lock();
+            }
+            for (size_t index = first; index < last; ++index) {
+                boundaries_[index] = std::move(target[index]);
+            }
+            layout_lock.unlock();
+
+            Redistribute(first, last);
+            for (size_t index = first; index <= last; ++index) {
+                shards_[index].mutex.unlock();
+            }
+            first = last;
+        }
+    }
+
+private:
+    size_t Route(const Key& key) const {
+        if (splitter_) {
+            return std::min(splitter_(key), shard_count_ - 1);
+        }
+        // неизвестные границы стоят в конце и означают +inf
+        size_t low = 0;
+        size_t high = shard_count_ - 1;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (!boundaries_[middle] || comparator_(key, *boundaries_[middle])) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        return low;
+    }
+
+    template<typename Lock>
+    size_t LockRoute(const Key& key, Lock& lock) const {
+        std::shared_lock layout_lock(layout_mutex_);
+        size_t index = Route(key);
+        lock = Lock(shards_[index].mutex);
+        return index;
+    }
+
+    // если в своем шарде ответа нет, он - минимум следующего непустого; замки берутся внахлест,
+    // чтобы ключи не переехали между шардами за спиной поиска
+    template<bool kUpper>
+    std::optional<Key> Bound(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock;
+        size_t index = LockRoute(key, lock);
+        TreeIterator it = kUpper ? shards_[index].tree.upper_bound(key) : shards_[index].tree.lower_bound(key);
+        while (it == shards_[index].tree.end()) {
+            if (++index == shard_count_) {
+                return std::nullopt;
+            }
+            std::shared_lock next(shards_[index].mutex);
+            lock = std::move(next);
+            it = shards_[index].tree.begin();
+        }
+        return *it;
+    }
+
+    bool SameBoundary(const std::optional<Key>& first, const std::optional<Key>& second) const {
+        if (!first || !second) {
+            return !first && !second;
+        }
+        return !comparator_(*first, *second) && !comparator_(*second, *first);
+    }
+
+    // граница i - ключ ранга (i + 1) * total / N. Ранги внутри шарда ищутся за один проход под одним замком,
+    // поэтому границы не убывают, даже если шарды меняются во время подсчета
+    std::unique_ptr<std::optional<Key>[]> Quantiles() const {
+        auto target = std::make_unique<std::optional<Key>[]>(shard_count_ - 1);
+        size_type total = size();
+        size_t next = 0;
+        size_type prefix = 0;
+        for (size_t index = 0; index < shard_count_ && next + 1 < shard_count_; ++index) {
+            std::shared_lock lock(shards_[index].mutex);
+            const Tree& tree = shards_[index].tree;
+            TreeIterator it = tree.begin();
+            size_type position = prefix;
+            for (; next + 1 < shard_count_; ++next) {
+                size_type rank = (next + 1) * total / shard_count_;
+                if (rank >= prefix + tree.size()) {
+                    break;
+                }
+                for (; position < rank; ++position) {
+                    ++it;
+                }
+                target[next] = *it;
+            }
+            prefix += tree.size();
+        }
+        return target;
+    }
+
+    // шарды с first по last заперты и уже живут по новым границам; ключи шарда i расходятся по ним отрезками
+    void Redistribute(size_t first, size_t last) {
+        for (size_t index = first; index <= last; ++index) {
+            Tree& tree = shards_[index].tree;
+            for (size_t target = last; target > index; --target) {
+                if (tree.empty()) {
+                    break;
+                }
+                if (boundaries_[target - 1]) {
+                    Tree upper = tree.split(*boundaries_[target - 1]);
+                    shards_[target].tree.merge(upper);
+                }
+            }
+            for (size_t target = first; target < index && !tree.empty(); ++target) {
+                if (!boundaries_[target]) {
+                    shards_[target].tree.merge(tree);
+                    break;
+                }
+                Tree upper = tree.split(*boundaries_[target]);
+                shards_[target].tree.merge(tree);
+                tree.swap(upper);
+            }
+        }
+    }
+
+    void RebalanceInBackground(std::stop_token stop) {
+        std::unique_lock lock(wakeup_mutex_);
+        while (!wakeup_.wait_for(lock, stop, kRebalancePeriod, [] { return false; })) {
+            if (stop.stop_requested()) {
+                return;
+            }
+            if (Skewed()) {
+                lock.unlock();
+                rebalance();
+                lock.lock();
+            }
+        }
+    }
+
+    bool Skewed() const {
+        size_type total = 0;
+        size_type largest = 0;
+        for (size_t index = 0; index < shard_count_; ++index) {
+            size_type size = shard_size(index);
+            total += size;
+            largest = std::max(largest, size);
+        }
+        return total >= kMinRebalanceSize && largest * shard_count_ > kSkewFactor * total;
+    }
+
+    size_t shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+    // boundaries_[i] - наименьший ключ шарда i + 1; меняются только под layout_mutex_ и rebalance_mutex_
+    std::unique_ptr<std::optional<Key>[]> boundaries_;
+    mutable std::shared_mutex layout_mutex_;
+    mutable std::mutex rebalance_mutex_;
+    Splitter splitter_;
+    Compare comparator_;
+
+    std::mutex wakeup_mutex_;
+    std::condition_variable_any wakeup_;
+    // объявлен последним, чтобы остановиться раньше, чем разрушатся шарды
+    std::jthread rebalancer_;
+};
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BST_X86_SIMD 1
+#endif
+
+#include "bst.h"
+#include "frozen.cpp"
+
+enum class SimdLevel {
+    kScalar,
+    kSse,
+    kAvx2,
+};
+
+inline SimdLevel DetectSimdLevel() {
+#ifdef BST_X86_SIMD
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::kAvx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SimdLevel::kSse;
+        }
+        return SimdLevel::kScalar;
+    }();
+    return level;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+// блок узла занимает одну кэш-линию; Rank<upper> считает ключи блока, меньшие key (или не большие при upper)
+template<typename Key>
+struct SimdBlock {};
+
+template<typename Key>
+struct ScalarRank {
+    static constexpr size_t kWidth = 64 / sizeof(Key);
+
+    static Key Padding() {
+        if constexpr (std::numeric_limits<Key>::has_infinity) {
+            return std::numeric_limits<Key>::infinity();
+        } else {
+            return std::numeric_limits<Key>::max();
+        }
+    }
+
+    template<bool upper>
+    static size_t RankScalar(const Key* block, Key key) {
+        size_t count = 0;
+        for (size_t index = 0; index < kWidth; ++index) {
+            count += upper ? !(key < block[index]) : block[index] < key;
+        }
+        return count;
+    }
+};
+
+template<>
+struct SimdBlock<int>: ScalarRank<int> {
+#ifdef BST_X86_SIMD
+    template<bool upper>
+    __attribute__((target("sse4.2"))) static size_t RankSse(const int* block, int key) {
+        __m128i broadcast = _mm_set1_epi32(key);
+        int mask = 0;
+        for (size_t index = 0; index < kWidth; index += 4) {
+            __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + index));
+            __m128i greater = upper ? _mm_cmpgt_epi32(keys, broadcast) : _mm_cmpgt_epi32(broadcast, keys);
+            mask |= _mm_movemask_ps(_mm_castsi128_ps(greater)) << index;
+        }
+        return upper ? kWidth - std::popcount(static_cast<unsigned>(mask)) : std::popcount(static_cast<unsigned>(mask));
+    }
+
+    template<bool upper>
+    __attribute__((target("avx2"))) static size_t RankAvx2(const int* block, int key) {
+        __m256i broadcast = _mm256_set1_epi32(key);
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 8));
+        __m256i low_greater = upper ? _mm256_cmpgt_epi32(low, broadcast) : _mm256_cmpgt_epi32(broadcast, low);
+        __m256i high_greater = upper ? _mm256_cmpgt_epi32(high, broadcast) : _mm256_cmpgt_epi32(broadcast, high);
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(low_greater)) | (_mm256_movemask_ps(_mm256_castsi256_ps(high_greater)) << 8);
+        return upper ? kWidth - std::popcount(mask) : std::popcount(mask);
+    }
+#endif
+};
+
+// в SSE/AVX2 нет беззнакового сравнения 64-битных чисел, поэтому сравниваем со сдвинутым знаковым битом
+template<>
+struct SimdBlock<uint64_t>: ScalarRank<uint64_t> {
+#ifdef BST_X86_SIMD
+    template<bool upper>
+    __attribute__((target("sse4.2"))) static size_t RankSse(const uint64_t* block, uint64_t key) {
+        __m128i sign = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+        __m128i broadcast = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(key)), sign);
+        int mask = 0;
+        for (size_t index = 0; index < kWidth; index += 2) {
+            __m128i keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + index)), sign);
+            __m128i greater = upper ? _mm_cmpgt_epi64(keys, broadcast) : _mm_cmpgt_epi64(broadcast, keys);
+            mask |= _mm_movemask_pd(_mm_castsi128_pd(greater)) << index;
+        }
+        return upper ? kWidth - std::popcount(static_cast<unsigned>(mask)) : std::popcount(static_cast<unsigned>(mask));
+    }
+
+    template<bool upper>
+    __attribute__((target("avx2"))) static size_t RankAvx2(const uint64_t* block, uint64_t key) {
+        __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+        __m256i broadcast = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), sign);
+        __m256i low = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), sign);
+        __m256i high = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 4)), sign);
+        __m256i low_greater = upper ? _mm256_cmpgt_epi64(low, broadcast) : _mm256_cmpgt_epi64(broadcast, low);
+        __m256i high_greater = upper ? _mm256_cmpgt_epi64(high, broadcast) : _mm256_cmpgt_epi64(broadcast, high);
+        unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(low_greater)) | (_mm256_movemask_pd(_mm256_castsi256_pd(high_greater)) << 4);
+        return upper ? kWidth - std::popcount(mask) : std::popcount(mask);
+    }
+#endif
+};
+
+template<>
+struct SimdBlock<double>: ScalarRank<double> {
+#ifdef BST_X86_SIMD
+    template<bool upper>
+    __attribute__((target("sse4.2"))) static size_t RankSse(const double* block, double key) {
+        __m128d broadcast = _mm_set1_pd(key);
+        int mask = 0;
+        for (size_t index = 0; index < kWidth; index += 2) {
+            __m128d keys = _mm_loadu_pd(block + index);
+            __m128d counted = upper ? _mm_cmple_pd(keys, broadcast) : _mm_cmplt_pd(keys, broadcast);
+            mask |= _mm_movemask_pd(counted) << index;
+        }
+        return std::popcount(static_cast<unsigned>(mask));
+    }
+
+    template<bool upper>
+    __attribute__((target("avx2"))) static size_t RankAvx2(const double* block, double key) {
+        __m256d broadcast = _mm256_set1_pd(key);
+        __m256d low = _mm256_loadu_pd(block);
+        __m256d high = _mm256_loadu_pd(block + 4);
+        __m256d low_counted = upper ? _mm256_cmp_pd(low, broadcast, _CMP_LE_OQ) : _mm256_cmp_pd(low, broadcast, _CMP_LT_OQ);
+        __m256d high_counted = upper ? _mm256_cmp_pd(high, broadcast, _CMP_LE_OQ) : _mm256_cmp_pd(high, broadcast, _CMP_LT_OQ);
+        unsigned mask = _mm256_movemask_pd(low_counted) | (_mm256_movemask_pd(high_counted) << 4);
+        return std::popcount(mask);
+    }
+#endif
+};
+
+template<typename Key, typename Compare>
+inline constexpr bool kSimdSearchable = requires { SimdBlock<Key>::kWidth; } && std::is_same_v<Compare, std::less<Key>>;
+
+// статическое B+-дерево (S+-tree): нижний слой - сами ключи по возрастанию, выше слои разделителей;
+// блок k слоя h ссылается на блоки k * (B + 1) + i слоя h - 1, разделитель i - минимум поддерева i + 1
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+requires kSimdSearchable<Key, Compare>
+class StaticBTree {
+    using Block = SimdBlock<Key>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr size_t kWidth = Block::kWidth;
+    static constexpr size_t kMaxHeight = 32;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    StaticBTree(key_compare = Compare(), const Allocator& alloc = Allocator()): alloc_(alloc) {}
+
+    // диапазон должен быть строго возрастающим
+    template<typename Iter>
+    StaticBTree(AssumeSorted, Iter iterator_start, Iter iterator_finish, key_compare comparator = Compare(), const Allocator& alloc = Allocator())
+        : StaticBTree(assume_sorted, iterator_start, static_cast<size_type>(std::distance(iterator_start, iterator_finish)), comparator, alloc) {}
+
+    template<typename Iter>
+    StaticBTree(AssumeSorted, Iter iterator_start, size_type count, key_compare = Compare(), const Allocator& alloc = Allocator()): alloc_(alloc) {
+        Allocate(count);
+        for (size_type index = 0; index < count; ++index, ++iterator_start) {
+            keys_[index] = *iterator_start;
+        }
+        BuildSeparators();
+    }
+
+    StaticBTree(const StaticBTree& other): alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)), level_(other.level_) {
+        Allocate(other.size_);
+        std::copy(other.keys_, other.keys_ + capacity_, keys_);
+    }
+
+    StaticBTree(StaticBTree&& other) noexcept: alloc_(std::move(other.alloc_)) {
+        StealFrom(other);
+    }
+
+    StaticBTree& operator=(StaticBTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~StaticBTree() {
+        if (keys_) {
+            alloc_.deallocate(keys_, capacity_);
+        }
+    }
+
+    iterator begin() const {
+        return keys_;
+    }
+
+    iterator end() const {
+        return keys_ + size_;
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    size_type size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    Compare key_comp() const {
+        return Compare();
+    }
+
+    Compare value_comp() const {
+        return Compare();
+    }
+
+    iterator lower_bound(Key key) const {
+        return begin() + Search<false>(key);
+    }
+
+    iterator upper_bound(Key key) const {
+        // разделители несуществующих поддеревьев равны Padding(), при key == Padding() спуск ушел бы в них
+        if (key == Block::Padding()) {
+            return end();
+        }
+        return begin() + Search<true>(key);
+    }
+
+    std::pair<iterator, iterator> equal_range(Key key) const {
+        iterator lower = lower_bound(key);
+        if (lower == end() || key < *lower) {
+            return std::make_pair(lower, lower);
+        }
+        return std::make_pair(lower, lower + 1);
+    }
+
+    iterator find(Key key) const {
+        iterator lower = lower_bound(key);
+        if (lower == end() || key < *lower) {
+            return end();
+        }
+        return lower;
+    }
+
+    size_type count(Key key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    bool contains(Key key) const {
+        return find(key) != end();
+    }
+
+    SimdLevel simd_level() const {
+        return level_;
+    }
+
+    // уровень выше поддерживаемого процессором понижается до него
+    void set_simd_level(SimdLevel level) {
+        level_ = std::min(level, DetectSimdLevel());
+    }
+
+    void swap(StaticBTree& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        std::swap(keys_, other.keys_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(height_, other.height_);
+        std::swap(offsets_, other.offsets_);
+        std::swap(level_, other.level_);
+    }
+
+private:
+    static size_type Blocks(size_type count) {
+        return (count + kWidth - 1) / kWidth;
+    }
+
+    static size_type KeysAbove(size_type count) {
+        return (Blocks(count) + kWidth) / (kWidth + 1) * kWidth;
+    }
+
+    void Allocate(size_type count) {
+        if (!count) {
+            return;
+        }
+        size_ = count;
+        height_ = 0;
+        for (size_type layer_size = count; ; layer_size = KeysAbove(layer_size)) {
+            offsets_[height_ + 1] = offsets_[height_] + Blocks(layer_size) * kWidth;
+            ++height_;
+            if (layer_size <= kWidth) {
+                break;
+            }
+        }
+        capacity_ = offsets_[height_];
+        keys_ = alloc_.allocate(capacity_);
+    }
+
+    void BuildSeparators() {
+        for (size_type index = size_; index < capacity_; ++index) {
+            keys_[index] = Block::Padding();
+        }
+        for (size_type layer = 1; layer < height_; ++layer) {
+            for (size_type index = 0; index < offsets_[layer + 1] - offsets_[layer]; ++index) {
+                size_type block = index / kWidth * (kWidth + 1) + index % kWidth + 1;
+                for (size_type depth = 1; depth < layer; ++depth) {
+                    block *= kWidth + 1;
+                }
+                keys_[offsets_[layer] + index] = block * kWidth < size_ ? keys_[block * kWidth] : Block::Padding();
+            }
+        }
+    }
+
+    void StealFrom(StaticBTree& other) {
+        keys_ = other.keys_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        height_ = other.height_;
+        std::copy(other.offsets_, other.offsets_ + kMaxHeight + 1, offsets_);
+        level_ = other.level_;
+        other.keys_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        other.height_ = 0;
+    }
+
+    template<bool upper>
+    size_type Search(Key key) const {
+        if (!size_) {
+            return 0;
+        }
+        size_type position;
+        switch (level_) {
+#ifdef BST_X86_SIMD
+            case SimdLevel::kAvx2:
+                position = DescendAvx2<upper>(key);
+                break;
+            case SimdLevel::kSse:
+                position = DescendSse<upper>(key);
+                break;
+#endif
+            default:
+                position = DescendScalar<upper>(key);
+        }
+        return std::min(position, size_);
+    }
+
+    // три копии одного спуска: Rank встраивается только в функцию с тем же набором инструкций
+    template<bool upper>
+    size_type DescendScalar(Key key) const {
+        size_type offset = 0;
+        for (size_type layer = height_ - 1; layer > 0; --layer) {
+            offset = offset * (kWidth + 1) + Block::template RankScalar<upper>(keys_ + offsets_[layer] + offset, key) * kWidth;
+        }
+        return offset + Block::template RankScalar<upper>(keys_ + offset, key);
+    }
+
+#ifdef BST_X86_SIMD
+    template<bool upper>
+    __attribute__((target("sse4.2"))) size_type DescendSse(Key key) const {
+        size_type offset = 0;
+        for (size_type layer = height_ - 1; layer > 0; --layer) {
+            offset = offset * (kWidth + 1) + Block::template RankSse<upper>(keys_ + offsets_[layer] + offset, key) * kWidth;
+        }
+        return offset + Block::template RankSse<upper>(keys_ + offset, key);
+    }
+
+    template<bool upper>
+    __attribute__((target("avx2"))) size_type DescendAvx2(Key key) const {
+        size_type offset = 0;
+        for (size_type layer = height_ - 1; layer > 0; --layer) {
+            offset = offset * (kWidth + 1) + Block::template RankAvx2<upper>(keys_ + offsets_[layer] + offset, key) * kWidth;
+        }
+        return offset + Block::template RankAvx2<upper>(keys_ + offset, key);
+    }
+#endif
+
+    Allocator alloc_;
+    Key* keys_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+    size_type height_ = 0;
+    size_type offsets_[kMaxHeight + 1] = {};
+    SimdLevel level_ = DetectSimdLevel();
+};
+
+template<typename Key, typename Compare, typename Allocator>
+void swap(StaticBTree<Key, Compare, Allocator>& first, StaticBTree<Key, Compare, Allocator>& second) noexcept {
+    first.swap(second);
+}
+
+template<typename Key, typename Compare, typename Allocator, bool simd = kSimdSearchable<Key, Compare>>
+struct FrozenIndexSelector {
+    using type = FrozenBinarySearchTree<Key, Compare, Allocator>;
+};
+
+template<typename Key, typename Compare, typename Allocator>
+struct FrozenIndexSelector<Key, Compare, Allocator, true> {
+    using type = StaticBTree<Key, Compare, Allocator>;
+};
+
+// снимок, который возвращает BinarySearchTree::freeze()
+template<typename Key, typename Compare, typename Allocator>
+using FrozenIndex = FrozenIndexSelector<Key, Compare, Allocator>::type;
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// пул потоков для fork-join: invoke(left, right) кладет right в дек текущего воркера, выполняет left и забирает right
+// обратно, если его никто не украл. Свободные воркеры крадут самые старые задачи - в рекурсивном разбиении это
+// самые крупные куски. Задачи живут на стеке породившего их вызова, invoke не возвращается, пока они не выполнены
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t thread_count = std::thread::hardware_concurrency())
+        : thread_count_(std::max<size_t>(thread_count, 1)), workers_(std::make_unique<Worker[]>(thread_count_)),
+          threads_(std::make_unique<std::thread[]>(thread_count_)) {
+        for (size_t i = 0; i < thread_count_; ++i) {
+            threads_[i] = std::thread([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (size_t i = 0; i < thread_count_; ++i) {
+            threads_[i].join();
+        }
+    }
+
+    static WorkStealingPool& global() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    size_t thread_count() const {
+        return thread_count_;
+    }
+
+    // выполняет function на воркере пула и ждет окончания; исключение пробрасывается вызывающему
+    template<typename Function>
+    void run(Function&& function) {
+        FunctionTask<Function> task(function);
+        if (CurrentWorker()) {
+            Execute(&task);
+        } else {
+            {
+                std::lock_guard lock(external_mutex_);
+                task.external = true;
+                task.next = external_;
+                external_ = &task;
+            }
+            Published();
+            // ждем на счетчике пула: после done задача может исчезнуть вместе с кадром стека, будить через нее нельзя
+            uint64_t completed = completed_external_.load(std::memory_order_acquire);
+            while (!task.done.load(std::memory_order_acquire)) {
+                completed_external_.wait(completed, std::memory_order_acquire);
+                completed = completed_external_.load(std::memory_order_acquire);
+            }
+        }
+        Rethrow(&task);
+    }
+
+    // выполняет left и right, возможно параллельно
+    template<typename Left, typename Right>
+    void invoke(Left&& left, Right&& right) {
+        Worker* worker = CurrentWorker();
+        if (!worker) {
+            run([&] { invoke(left, right); });
+            return;
+        }
+
+        FunctionTask<Right> task(right);
+        if (!worker->Push(&task)) {
+            left();
+            right();
+            return;
+        }
+        Published();
+
+        try {
+            left();
+        } catch (...) {
+            // right ссылается на этот кадр стека, уходить раньше него нельзя
+            Join(worker, &task);
+            throw;
+        }
+        Join(worker, &task);
+        Rethrow(&task);
+    }
+
+private:
+    // глубина вложенности invoke у одного воркера ограничена высотой рекурсии; при переполнении right выполняется сразу
+    static constexpr size_t kDequeCapacity = 256;
+
+    struct Task {
+        explicit Task(void (*run)(Task*)): run(run) {}
+
+        void (*run)(Task*);
+        Task* next = nullptr;
+        bool external = false;
+        std::exception_ptr error;
+        std::atomic<bool> done = false;
+    };
+
+    template<typename Function>
+    struct FunctionTask: Task {
+        explicit FunctionTask(Function& function): Task(&Run), function(function) {}
+
+        static void Run(Task* task) {
+            static_cast<FunctionTask*>(task)->function();
+        }
+
+        Function& function;
+    };
+
+    // дек под мьютексом: задачи крупные, а крадут редко, так что соперничества за него почти нет
+    struct alignas(64) Worker {
+        bool Push(Task* task) {
+            std::lock_guard lock(mutex);
+            if (bottom - top == kDequeCapacity) {
+                return false;
+            }
+            tasks[bottom++ % kDequeCapacity] = task;
+            return true;
+        }
+
+        Task* Pop() {
+            std::lock_guard lock(mutex);
+            return bottom == top ? nullptr : tasks[--bottom % kDequeCapacity];
+        }
+
+        bool PopIf(Task* task) {
+            std::lock_guard lock(mutex);
+            if (bottom == top || tasks[(bottom - 1) % kDequeCapacity] != task) {
+                return false;
+            }
+            --bottom;
+            return true;
+        }
+
+        Task* Steal() {
+            std::lock_guard lock(mutex);
+            return bottom == top ? nullptr : tasks[top++ % kDequeCapacity];
+        }
+
+        std::mutex mutex;
+        Task* tasks[kDequeCapacity];
+        size_t top = 0;
+        size_t bottom = 0;
+    };
+
+    struct Current {
+        WorkStealingPool* pool = nullptr;
+        Worker* worker = nullptr;
+    };
+
+    static Current& ThreadCurrent() {
+        thread_local Current current;
+        return current;
+    }
+
+    Worker* CurrentWorker() const {
+        const Current& current = ThreadCurrent();
+        return current.pool == this ? current.worker : nullptr;
+    }
+
+    void Execute(Task* task) {
+        try {
+            task->run(task);
+        } catch (...) {
+            task->error = std::current_exception();
+        }
+        bool external = task->external;
+        task->done.store(true, std::memory_order_release);
+        if (external) {
+            completed_external_.fetch_add(1, std::memory_order_release);
+            completed_external_.notify_all();
+        }
+    }
+
+    static void Rethrow(Task* task) {
+        if (task->error) {
+            std::rethrow_exception(task->error);
+        }
+    }
+
+    // если задачу не украли, после left она снова на дне дека; иначе, пока вор ее не закончит, выполняем чужую работу
+    void Join(Worker* worker, Task* task) {
+        if (worker->PopIf(task)) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            Execute(task);
+            return;
+        }
+        while (!task->done.load(std::memory_order_acquire)) {
+            if (!RunOne(worker)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool RunOne(Worker* worker) {
+        Task* task = worker->Pop();
+        for (size_t i = 1; !task && i < thread_count_; ++i) {
+            task = workers_[(worker - workers_.get() + i) % thread_count_].Steal();
+        }
+        if (!task) {
+            task = TakeExternal();
+        }
+        if (!task) {
+            return false;
+        }
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        Execute(task);
+        return true;
+    }
+
+    Task* TakeExternal() {
+        std::lock_guard lock(external_mutex_);
+        Task* task = external_;
+        if (task) {
+            external_ = task->next;
+        }
+        return task;
+    }
+
+    // пара к проверке в WorkerLoop: либо воркер увидит новую задачу, либо мы увидим уснувшего воркера
+    void Published() {
+        queued_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+            std::lock_guard lock(sleep_mutex_);
+            sleep_cv_.notify_one();
+        }
+    }
+
+    void WorkerLoop(size_t index) {
+        ThreadCurrent() = {this, &workers_[index]};
+        while (true) {
+            if (RunOne(&workers_[index])) {
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            sleep_cv_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_seq_cst) > 0; });
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if (stop_) {
+                return;
+            }
+        }
+    }
+
+    size_t thread_count_;
+    std::unique_ptr<Worker[]> workers_;
+    std::unique_ptr<std::thread[]> threads_;
+
+    // задачи из потоков вне пула
+    std::mutex external_mutex_;
+    Task* external_ = nullptr;
+    std::atomic<uint64_t> completed_external_ = 0;
+
+    // сколько задач лежит в деках и во внешнем списке; по нему засыпают и просыпаются воркеры
+    // задачу могут украсть раньше, чем владелец ее посчитает, поэтому счетчик знаковый и ненадолго уходит в минус
+    std::atomic<ptrdiff_t> queued_ = 0;
+    std::atomic<size_t> sleepers_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+};
@@ -1,527 +1,1533 @@
-#include <lib/bst.cpp>
-#include <gtest/gtest.h>
-#include <set>
-#include <vector>
-
-void FillTree(BinarySearchTree<int>& tree, int i_max = 1000) {
-    for (int i = 0; i < i_max; ++i) {
-        tree.insert(i);
-    }
-}
-
-void FillSet(std::set<int>& set, int i_max = 1000) {
-    for (int i = 0; i < i_max; ++i) {
-        set.insert(i);
-    }
-}
-
-template<typename T>
-void FillSmartly(T& cont, int i_max = 1000, int left = 0, int right = 1000) {
-    int mid = (left + right) / 2;
-    cont.insert(mid);
-    if (left >= right - i_max / 20) {
-        return;
-    }
-    FillSmartly(cont, i_max, mid, right);
-    FillSmartly(cont, i_max, left, mid);
-}
-
-template<typename Key, typename Comp = std::less<Key>>
-bool EqualToSet(const BinarySearchTree<Key, Comp>& tree, const std::set<Key, Comp>& set) {
-    if (tree.size() != set.size()) {
-        return false;
-    }
-
-    auto it_tree = tree.begin();
-    auto it_set = set.begin();
-
-    while (it_tree != tree.end()) {
-        if (*it_tree != *it_set) {
-            return false;
-        }
-        ++it_tree;
-        ++it_set;
-    }
-
-    return true;
-}
-
-
-TEST(bstTestSuite, EmptyTest) {
-    BinarySearchTree<int> a;
-    ASSERT_TRUE(a.empty());
-    a.insert(123);
-    ASSERT_FALSE(a.empty());
-    a.erase(123);
-    ASSERT_TRUE(a.empty());
-}
-
-TEST(bstTestSuite, EqualTest) {
-    BinarySearchTree<int> a;
-    BinarySearchTree<int> b;
-
-    FillTree(a);
-    FillTree(b);
-
-    ASSERT_TRUE(a == b);
-    ASSERT_TRUE(b == b);
-    a.insert(-1);
-    ASSERT_TRUE(a != b);
-    ASSERT_TRUE(b != a);
-
-    a.clear();
-    b.clear();
-}
-
-TEST(bstTestSuite, ConstructorsTest) {
-    BinarySearchTree<int> a;
-    FillTree(a);
-    BinarySearchTree<int> b(a);
-    BinarySearchTree<int> c = a;
-    c = b;
-
-    ASSERT_TRUE(a == b);
-    ASSERT_TRUE(b == a);
-    ASSERT_TRUE(b == c);
-    ASSERT_TRUE(c == c);
-    ASSERT_TRUE(c == a);
-    ASSERT_TRUE(a == c);
-
-    BinarySearchTree d {1, 2, 3, 4, -1, -2, -3};
-    BinarySearchTree d_copy = d;
-
-    ASSERT_TRUE(d == d_copy);
-}
-
-TEST(bstTestSuite, InsertEraseSizeTest) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillTree(tree);
-    FillSet(set);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-        }
-    }
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-    ASSERT_TRUE(tree.size() == set.size());
-
-    tree.clear();
-    set.clear();
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-        }
-    }
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-    ASSERT_TRUE(tree.size() == set.size());
-}
-
-TEST(bstTestSuite, InsertResultIteratorTest) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillTree(tree);
-    FillSet(set);
-
-    auto tree_it = tree.insert(123).first;
-    auto set_it = set.insert(123).first;
-
-    ASSERT_TRUE(*tree_it == *set_it);
-    ASSERT_TRUE(*++tree_it == *++set_it);
-    ASSERT_TRUE(*--tree_it == *--set_it);
-    ASSERT_TRUE(*tree_it++ == *set_it++);
-    ASSERT_TRUE(*tree_it-- == *set_it--);
-}
-
-TEST(bstTestSuite, InsertByIteratorsTest) {
-    std::vector<int> a {1, 3, -2, -5, 3, 5, 7, 3, 9, -10, -24, -5};
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    tree.insert(a.begin(), a.end());
-    set.insert(a.begin(), a.end());
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-}
-
-TEST(bstTestSuite, InsertByInitializerListTest) {
-    std::initializer_list<int> a {1, 3, -2, -5, 3, 5, 7, 3, 9, -10, -24, -5};
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    tree.insert(a);
-    set.insert(a);
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-}
-
-template<typename iterator_type>
-struct comparator_of_iterators {
-
-    bool operator()(const iterator_type& it1, const iterator_type& it2) const {
-        return &it1 < &it2;
-    }
-};
-
-
-TEST(bstTestSuite, EraseByIterator) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    std::set<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_set;
-    std::set<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_set;
-
-    BinarySearchTree<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_bst;
-    BinarySearchTree<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_bst;
-
-
-    for (int i = 5; i < 1000; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree_iterators_in_set.insert(tree.insert(i).first);
-            tree_iterators_in_bst.insert(tree.insert(i).first);
-
-            set_iterators_in_set.insert(set.insert(i).first);
-            set_iterators_in_bst.insert(set.insert(i).first);
-        }
-    }
-
-    ASSERT_TRUE(EqualToSet(tree_iterators_in_bst, tree_iterators_in_set));
-    ASSERT_TRUE(EqualToSet(set_iterators_in_bst, set_iterators_in_set));
-
-    for (auto it: tree_iterators_in_set) {
-        tree.erase(it);
-    }
-
-    for (auto it: set_iterators_in_set) {
-        set.erase(it);
-    }
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-}
-
-TEST(bstTestSuite, EraseByIteratorsRange) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    std::set<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_set;
-    std::set<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_set;
-
-    BinarySearchTree<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_bst;
-    BinarySearchTree<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_bst;
-
-
-    for (int i = 5; i < 2000; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree_iterators_in_set.insert(tree.insert(i).first);
-            tree_iterators_in_bst.insert(tree.insert(i).first);
-
-            set_iterators_in_set.insert(set.insert(i).first);
-            set_iterators_in_bst.insert(set.insert(i).first);
-        }
-    }
-
-    tree.erase(*tree_iterators_in_bst.begin(), *tree_iterators_in_bst.end());
-    set.erase(*set_iterators_in_set.begin(), *set_iterators_in_set.end());
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-}
-
-TEST(bstTestSuite, FindTest) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-        }
-    }
-    bool flag = true;
-    for (int i = 0; i < 1000; ++i) {
-        if (tree.find(i) == tree.end()) {
-            if (set.find(i) != set.end()) {
-                flag = false;
-                break;
-            }
-        } else {
-            if (*tree.find(i) != *set.find(i)) {
-                flag = false;
-            }
-        }
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, LowerBoundTest) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-        }
-    }
-    bool flag = true;
-    for (int i = 0; i < 1000; ++i) {
-        if (tree.lower_bound(i) == tree.end()) {
-            if (set.lower_bound(i) != set.end()) {
-                flag = false;
-                break;
-            }
-        } else {
-            if (*tree.lower_bound(i) != *set.lower_bound(i)) {
-                flag = false;
-            }
-        }
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, UpperBoundTest) {
-    BinarySearchTree<int> tree;
-    std::set<int> set;
-
-    FillSmartly(set);
-    FillSmartly(tree);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-        }
-    }
-    bool flag = true;
-    for (int i = 0; i < 1000; ++i) {
-        if (tree.upper_bound(i) == tree.end()) {
-            if (set.upper_bound(i) != set.end()) {
-                flag = false;
-                break;
-            }
-        } else {
-            if (*tree.upper_bound(i) != *set.upper_bound(i)) {
-                flag = false;
-            }
-        }
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, SwapTest) {
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int> tree2;
-
-    std::set<int> set;
-    std::set<int> set2;
-
-    FillSmartly(set);
-    FillSmartly(set2);
-    FillSmartly(tree);
-    FillSmartly(tree2);
-
-    for (int i = 5; i < 567; i += 2) {
-        tree.erase(i);
-        set.erase(i);
-        tree.erase(i);
-        set.erase(i);
-
-        if (i % 74 == 0) {
-            tree.insert(i);
-            set.insert(i);
-            tree.insert(i);
-            set.insert(i);
-            tree2.erase(i);
-            set2.erase(i);
-        }
-    }
-
-    set.swap(set2);
-    tree.swap(tree2);
-
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-    ASSERT_TRUE(EqualToSet(tree2, set2));
-}
-
-TEST(bstTestSuite, EmptySwapTest) {
-    BinarySearchTree<int> tree;
-    BinarySearchTree<int> tree2;
-
-    std::set<int> set;
-    std::set<int> set2;
-
-    tree.swap(tree2);
-    set.swap(set2);
-
-    FillSmartly(set);
-    FillSet(set2);
-
-    FillSmartly(tree);
-    FillTree(tree2);
-
-    ASSERT_TRUE(EqualToSet(tree, set));
-    ASSERT_TRUE(EqualToSet(tree2, set2));
-}
-
-TEST(bstTestSuite, PostOrderTest) {
-    BinarySearchTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-    float right_order[] {-2, -1, 0.6, 0.7, 0.5, 0, 4, 3, 7, 9, 8, 15, 10, 6, 5, 1};
-
-    auto it = a.begin<PostOrder>();
-    int index = 0;
-    bool flag = true;
-    while (it != a.end<PostOrder>()) {
-        if (*it != right_order[index]) {
-            flag = false;
-            break;
-        }
-        ++it;
-        --it;
-        it++;
-        it--;
-        ++it;
-        ++index;
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, PostOrderReverseTest) {
-    BinarySearchTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-    float right_order[] {-2, -1, 0.6, 0.7, 0.5, 0, 4, 3, 7, 9, 8, 15, 10, 6, 5, 1};
-
-    auto it = a.rbegin<PostOrder>();
-    int index = 0;
-    bool flag = true;
-    while (it != a.rend<PostOrder>()) {
-        if (*it != right_order[a.size() - 1 - index]) {
-            flag = false;
-            break;
-        }
-        ++it;
-        --it;
-        it++;
-        it--;
-        ++it;
-        ++index;
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, PreOrderTest) {
-    BinarySearchTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-    float right_order[] {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-
-    auto it = a.begin<PreOrder>();
-    int index = 0;
-    bool flag = true;
-    while (it != a.end<PreOrder>()) {
-        if (*it != right_order[index]) {
-            flag = false;
-            break;
-        }
-        ++it;
-        --it;
-        it++;
-        it--;
-        ++it;
-        ++index;
-    }
-
-    ASSERT_TRUE(flag);
-}
-
-TEST(bstTestSuite, PreOrderReverseTest) {
-    BinarySearchTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-    float right_order[] {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
-
-    auto it = a.rbegin<PreOrder>();
-    int index = 0;
-    bool flag = true;
-    while (it != a.rend<PreOrder>()) {
-        if (*it != right_order[a.size() - 1 - index]) {
-            flag = false;
-            break;
-        }
-        ++it;
-        --it;
-        it++;
-        it--;
-        ++it;
-        ++index;
-    }
-
-    ASSERT_TRUE(flag);
-}
-
+#include <lib/bst.cpp>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <atomic>
+#include <numeric>
+
+void FillTree(BinarySearchTree<int>& tree, int i_max = 1000) {
+    for (int i = 0; i < i_max; ++i) {
+        tree.insert(i);
+    }
+}
+
+void FillSet(std::set<int>& set, int i_max = 1000) {
+    for (int i = 0; i < i_max; ++i) {
+        set.insert(i);
+    }
+}
+
+template<typename T>
+void FillSmartly(T& cont, int i_max = 1000, int left = 0, int right = 1000) {
+    int mid = (left + right) / 2;
+    cont.insert(mid);
+    if (left >= right - i_max / 20) {
+        return;
+    }
+    FillSmartly(cont, i_max, mid, right);
+    FillSmartly(cont, i_max, left, mid);
+}
+
+template<typename Key>
+using UnbalancedTree = BinarySearchTree<Key, std::less<Key>, std::allocator<Key>, Unbalanced>;
+
+template<typename Key, typename Comp = std::less<Key>, typename Balancing = RedBlack>
+bool EqualToSet(const BinarySearchTree<Key, Comp, std::allocator<Key>, Balancing>& tree, const std::set<Key, Comp>& set) {
+    if (tree.size() != set.size()) {
+        return false;
+    }
+
+    auto it_tree = tree.begin();
+    auto it_set = set.begin();
+
+    while (it_tree != tree.end()) {
+        if (*it_tree != *it_set) {
+            return false;
+        }
+        ++it_tree;
+        ++it_set;
+    }
+
+    return true;
+}
+
+
+TEST(bstTestSuite, EmptyTest) {
+    BinarySearchTree<int> a;
+    ASSERT_TRUE(a.empty());
+    a.insert(123);
+    ASSERT_FALSE(a.empty());
+    a.erase(123);
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(bstTestSuite, EqualTest) {
+    BinarySearchTree<int> a;
+    BinarySearchTree<int> b;
+
+    FillTree(a);
+    FillTree(b);
+
+    ASSERT_TRUE(a == b);
+    ASSERT_TRUE(b == b);
+    a.insert(-1);
+    ASSERT_TRUE(a != b);
+    ASSERT_TRUE(b != a);
+
+    a.clear();
+    b.clear();
+}
+
+TEST(bstTestSuite, ConstructorsTest) {
+    BinarySearchTree<int> a;
+    FillTree(a);
+    BinarySearchTree<int> b(a);
+    BinarySearchTree<int> c = a;
+    c = b;
+
+    ASSERT_TRUE(a == b);
+    ASSERT_TRUE(b == a);
+    ASSERT_TRUE(b == c);
+    ASSERT_TRUE(c == c);
+    ASSERT_TRUE(c == a);
+    ASSERT_TRUE(a == c);
+
+    BinarySearchTree d {1, 2, 3, 4, -1, -2, -3};
+    BinarySearchTree d_copy = d;
+
+    ASSERT_TRUE(d == d_copy);
+}
+
+TEST(bstTestSuite, InsertEraseSizeTest) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillTree(tree);
+    FillSet(set);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+        }
+    }
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(tree.size() == set.size());
+
+    tree.clear();
+    set.clear();
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+        }
+    }
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(tree.size() == set.size());
+}
+
+TEST(bstTestSuite, InsertResultIteratorTest) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillTree(tree);
+    FillSet(set);
+
+    auto tree_it = tree.insert(123).first;
+    auto set_it = set.insert(123).first;
+
+    ASSERT_TRUE(*tree_it == *set_it);
+    ASSERT_TRUE(*++tree_it == *++set_it);
+    ASSERT_TRUE(*--tree_it == *--set_it);
+    ASSERT_TRUE(*tree_it++ == *set_it++);
+    ASSERT_TRUE(*tree_it-- == *set_it--);
+}
+
+TEST(bstTestSuite, InsertByIteratorsTest) {
+    std::vector<int> a {1, 3, -2, -5, 3, 5, 7, 3, 9, -10, -24, -5};
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    tree.insert(a.begin(), a.end());
+    set.insert(a.begin(), a.end());
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+}
+
+TEST(bstTestSuite, InsertByInitializerListTest) {
+    std::initializer_list<int> a {1, 3, -2, -5, 3, 5, 7, 3, 9, -10, -24, -5};
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    tree.insert(a);
+    set.insert(a);
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+}
+
+template<typename iterator_type>
+struct comparator_of_iterators {
+
+    bool operator()(const iterator_type& it1, const iterator_type& it2) const {
+        return &it1 < &it2;
+    }
+};
+
+
+TEST(bstTestSuite, EraseByIterator) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    std::set<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_set;
+    std::set<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_set;
+
+    BinarySearchTree<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_bst;
+    BinarySearchTree<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_bst;
+
+
+    for (int i = 5; i < 1000; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree_iterators_in_set.insert(tree.insert(i).first);
+            tree_iterators_in_bst.insert(tree.insert(i).first);
+
+            set_iterators_in_set.insert(set.insert(i).first);
+            set_iterators_in_bst.insert(set.insert(i).first);
+        }
+    }
+
+    ASSERT_TRUE(EqualToSet(tree_iterators_in_bst, tree_iterators_in_set));
+    ASSERT_TRUE(EqualToSet(set_iterators_in_bst, set_iterators_in_set));
+
+    for (auto it: tree_iterators_in_set) {
+        tree.erase(it);
+    }
+
+    for (auto it: set_iterators_in_set) {
+        set.erase(it);
+    }
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+}
+
+TEST(bstTestSuite, EraseByIteratorsRange) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    std::set<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_set;
+    std::set<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_set;
+
+    BinarySearchTree<BinarySearchTree<int>::iterator<InOrder>, comparator_of_iterators<BinarySearchTree<int>::iterator<InOrder>>> tree_iterators_in_bst;
+    BinarySearchTree<std::set<int>::iterator, comparator_of_iterators<std::set<int>::iterator>> set_iterators_in_bst;
+
+
+    for (int i = 5; i < 2000; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree_iterators_in_set.insert(tree.insert(i).first);
+            tree_iterators_in_bst.insert(tree.insert(i).first);
+
+            set_iterators_in_set.insert(set.insert(i).first);
+            set_iterators_in_bst.insert(set.insert(i).first);
+        }
+    }
+
+    tree.erase(*tree_iterators_in_bst.begin(), *tree_iterators_in_bst.end());
+    set.erase(*set_iterators_in_set.begin(), *set_iterators_in_set.end());
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+}
+
+TEST(bstTestSuite, FindTest) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+        }
+    }
+    bool flag = true;
+    for (int i = 0; i < 1000; ++i) {
+        if (tree.find(i) == tree.end()) {
+            if (set.find(i) != set.end()) {
+                flag = false;
+                break;
+            }
+        } else {
+            if (*tree.find(i) != *set.find(i)) {
+                flag = false;
+            }
+        }
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, LowerBoundTest) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+        }
+    }
+    bool flag = true;
+    for (int i = 0; i < 1000; ++i) {
+        if (tree.lower_bound(i) == tree.end()) {
+            if (set.lower_bound(i) != set.end()) {
+                flag = false;
+                break;
+            }
+        } else {
+            if (*tree.lower_bound(i) != *set.lower_bound(i)) {
+                flag = false;
+            }
+        }
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, UpperBoundTest) {
+    BinarySearchTree<int> tree;
+    std::set<int> set;
+
+    FillSmartly(set);
+    FillSmartly(tree);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+        }
+    }
+    bool flag = true;
+    for (int i = 0; i < 1000; ++i) {
+        if (tree.upper_bound(i) == tree.end()) {
+            if (set.upper_bound(i) != set.end()) {
+                flag = false;
+                break;
+            }
+        } else {
+            if (*tree.upper_bound(i) != *set.upper_bound(i)) {
+                flag = false;
+            }
+        }
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, SwapTest) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> tree2;
+
+    std::set<int> set;
+    std::set<int> set2;
+
+    FillSmartly(set);
+    FillSmartly(set2);
+    FillSmartly(tree);
+    FillSmartly(tree2);
+
+    for (int i = 5; i < 567; i += 2) {
+        tree.erase(i);
+        set.erase(i);
+        tree.erase(i);
+        set.erase(i);
+
+        if (i % 74 == 0) {
+            tree.insert(i);
+            set.insert(i);
+            tree.insert(i);
+            set.insert(i);
+            tree2.erase(i);
+            set2.erase(i);
+        }
+    }
+
+    set.swap(set2);
+    tree.swap(tree2);
+
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(EqualToSet(tree2, set2));
+}
+
+TEST(bstTestSuite, EmptySwapTest) {
+    BinarySearchTree<int> tree;
+    BinarySearchTree<int> tree2;
+
+    std::set<int> set;
+    std::set<int> set2;
+
+    tree.swap(tree2);
+    set.swap(set2);
+
+    FillSmartly(set);
+    FillSet(set2);
+
+    FillSmartly(tree);
+    FillTree(tree2);
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(EqualToSet(tree2, set2));
+}
+
+TEST(bstTestSuite, PostOrderTest) {
+    UnbalancedTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+    float right_order[] {-2, -1, 0.6, 0.7, 0.5, 0, 4, 3, 7, 9, 8, 15, 10, 6, 5, 1};
+
+    auto it = a.begin<PostOrder>();
+    int index = 0;
+    bool flag = true;
+    while (it != a.end<PostOrder>()) {
+        if (*it != right_order[index]) {
+            flag = false;
+            break;
+        }
+        ++it;
+        --it;
+        it++;
+        it--;
+        ++it;
+        ++index;
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, PostOrderReverseTest) {
+    UnbalancedTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+    float right_order[] {-2, -1, 0.6, 0.7, 0.5, 0, 4, 3, 7, 9, 8, 15, 10, 6, 5, 1};
+
+    auto it = a.rbegin<PostOrder>();
+    int index = 0;
+    bool flag = true;
+    while (it != a.rend<PostOrder>()) {
+        if (*it != right_order[a.size() - 1 - index]) {
+            flag = false;
+            break;
+        }
+        ++it;
+        --it;
+        it++;
+        it--;
+        ++it;
+        ++index;
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, PreOrderTest) {
+    UnbalancedTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+    float right_order[] {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+
+    auto it = a.begin<PreOrder>();
+    int index = 0;
+    bool flag = true;
+    while (it != a.end<PreOrder>()) {
+        if (*it != right_order[index]) {
+            flag = false;
+            break;
+        }
+        ++it;
+        --it;
+        it++;
+        it--;
+        ++it;
+        ++index;
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, PreOrderReverseTest) {
+    UnbalancedTree<float> a {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+    float right_order[] {1, 0, -1, -2, 0.5, 0.7, 0.6, 5, 3, 4, 6, 10, 8, 7, 9, 15};
+
+    auto it = a.rbegin<PreOrder>();
+    int index = 0;
+    bool flag = true;
+    while (it != a.rend<PreOrder>()) {
+        if (*it != right_order[a.size() - 1 - index]) {
+            flag = false;
+            break;
+        }
+        ++it;
+        --it;
+        it++;
+        it--;
+        ++it;
+        ++index;
+    }
+
+    ASSERT_TRUE(flag);
+}
+
+TEST(bstTestSuite, RedBlackShapeTest) {
+    BinarySearchTree<int> a;
+    FillTree(a, 7);
+    int pre_order[] {1, 0, 3, 2, 5, 4, 6};
+    int post_order[] {0, 2, 4, 6, 5, 3, 1};
+
+    ASSERT_TRUE(std::equal(a.begin<PreOrder>(), a.end<PreOrder>(), pre_order));
+    ASSERT_TRUE(std::equal(a.begin<PostOrder>(), a.end<PostOrder>(), post_order));
+    ASSERT_TRUE(std::equal(a.rbegin<PreOrder>(), a.rend<PreOrder>(), std::rbegin(pre_order)));
+    ASSERT_TRUE(std::equal(a.rbegin<PostOrder>(), a.rend<PostOrder>(), std::rbegin(post_order)));
+}
+
+template<typename Tree, typename traversal_type>
+bool TraversalIsConsistent(const Tree& tree) {
+    std::vector<int> forward;
+    std::vector<int> backward;
+    for (auto it = tree.template begin<traversal_type>(); it != tree.template end<traversal_type>(); ++it) {
+        forward.push_back(*it);
+    }
+    for (auto it = tree.template rbegin<traversal_type>(); it != tree.template rend<traversal_type>(); ++it) {
+        backward.push_back(*it);
+    }
+    std::reverse(backward.begin(), backward.end());
+    return forward.size() == tree.size() && forward == backward;
+}
+
+template<typename Balancing>
+void CheckRandomOperations() {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, Balancing>;
+    Tree tree;
+    std::set<int> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 2000);
+
+    for (int i = 0; i < 20000; ++i) {
+        int key = distribution(generator);
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else if (i % 3 == 1) {
+            ASSERT_EQ(tree.contains(key), set.contains(key));
+            ASSERT_EQ(tree.lower_bound(key) == tree.end(), set.lower_bound(key) == set.end());
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+        if (i % 1000 == 0) {
+            ASSERT_TRUE((TraversalIsConsistent<Tree, PreOrder>(tree)));
+            ASSERT_TRUE((TraversalIsConsistent<Tree, PostOrder>(tree)));
+        }
+    }
+
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, InOrder>(tree)));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PreOrder>(tree)));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PostOrder>(tree)));
+
+    while (!tree.empty()) {
+        tree.erase(tree.begin());
+    }
+    ASSERT_TRUE(tree.begin() == tree.end());
+    ASSERT_TRUE(tree.template begin<PostOrder>() == tree.template end<PostOrder>());
+}
+
+TEST(bstTestSuite, UnbalancedRandomOperationsTest) {
+    CheckRandomOperations<Unbalanced>();
+}
+
+TEST(bstTestSuite, RedBlackRandomOperationsTest) {
+    CheckRandomOperations<RedBlack>();
+}
+
+TEST(bstTestSuite, AVLRandomOperationsTest) {
+    CheckRandomOperations<AVL>();
+}
+
+TEST(bstTestSuite, TreapRandomOperationsTest) {
+    CheckRandomOperations<Treap>();
+}
+
+TEST(bstTestSuite, SplayRandomOperationsTest) {
+    CheckRandomOperations<Splay>();
+}
+
+TEST(bstTestSuite, ScapegoatRandomOperationsTest) {
+    CheckRandomOperations<Scapegoat>();
+}
+
+TEST(bstTestSuite, AVLShapeTest) {
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, AVL> a;
+    for (int i = 0; i < 7; ++i) {
+        a.insert(i);
+    }
+    int pre_order[] {3, 1, 0, 2, 5, 4, 6};
+
+    ASSERT_TRUE(std::equal(a.begin<PreOrder>(), a.end<PreOrder>(), pre_order));
+}
+
+TEST(bstTestSuite, SplayFindMovesToRootTest) {
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, Splay> a {5, 3, 8, 1, 4, 7, 9};
+    a.find(4);
+    ASSERT_EQ(*a.begin<PreOrder>(), 4);
+    a.lower_bound(6);
+    ASSERT_EQ(*a.begin<PreOrder>(), 7);
+    ASSERT_EQ(*a.rbegin<PostOrder>(), 7);
+    ASSERT_TRUE((TraversalIsConsistent<decltype(a), PostOrder>(a)));
+}
+
+TEST(bstTestSuite, RedBlackSequentialInsertTest) {
+    BinarySearchTree<int> tree;
+    FillTree(tree, 200000);
+
+    ASSERT_EQ(tree.size(), 200000);
+    ASSERT_EQ(*tree.begin(), 0);
+    ASSERT_EQ(*tree.rbegin(), 199999);
+    for (int i = 0; i < 200000; i += 1000) {
+        ASSERT_EQ(*tree.find(i), i);
+    }
+    for (int i = 0; i < 200000; i += 2) {
+        tree.erase(i);
+    }
+    ASSERT_EQ(tree.size(), 100000);
+    ASSERT_EQ(*tree.begin(), 1);
+}
+
+struct CountingKey {
+    static inline int constructed = 0;
+
+    int value;
+
+    CountingKey(int value): value(value) {
+        ++constructed;
+    }
+
+    CountingKey(const CountingKey& other): value(other.value) {
+        ++constructed;
+    }
+
+    CountingKey(CountingKey&& other) noexcept: value(other.value) {}
+
+    bool operator<(const CountingKey& other) const {
+        return value < other.value;
+    }
+};
+
+int allocations_count = 0;
+
+template<typename T>
+struct CountingAllocator: std::allocator<T> {
+    template<typename U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        ++allocations_count;
+        return std::allocator<T>::allocate(count);
+    }
+};
+
+TEST(bstTestSuite, DuplicateInsertDoesNotAllocateTest) {
+    BinarySearchTree<int, std::less<int>, CountingAllocator<int>> tree;
+    FillSmartly(tree);
+    int allocations = allocations_count;
+
+    FillSmartly(tree);
+    for (int key: {*tree.begin(), 500, *tree.rbegin()}) {
+        ASSERT_FALSE(tree.insert(key).second);
+        ASSERT_FALSE(tree.emplace(key).second);
+        ASSERT_FALSE(tree.try_emplace(key).second);
+    }
+    ASSERT_EQ(allocations_count, allocations);
+
+    ASSERT_TRUE(tree.insert(-1).second);
+    ASSERT_EQ(allocations_count, allocations + 1);
+}
+
+TEST(bstTestSuite, EmplaceTest) {
+    BinarySearchTree<CountingKey> tree;
+    CountingKey::constructed = 0;
+
+    ASSERT_TRUE(tree.emplace(5).second);
+    ASSERT_TRUE(tree.insert(CountingKey(3)).second);
+    ASSERT_TRUE(tree.try_emplace(CountingKey(7), 7).second);
+    ASSERT_EQ(CountingKey::constructed, 4);
+
+    ASSERT_FALSE(tree.try_emplace(CountingKey(5), 5).second);
+    ASSERT_FALSE(tree.emplace(3).second);
+    ASSERT_EQ(CountingKey::constructed, 6);
+
+    auto it = tree.begin();
+    ASSERT_EQ((it++)->value, 3);
+    ASSERT_EQ((it++)->value, 5);
+    ASSERT_EQ((it++)->value, 7);
+    ASSERT_TRUE(it == tree.end());
+}
+
+template<typename Tree>
+bool SameShape(const Tree& first, const Tree& second) {
+    return first.size() == second.size()
+        && std::equal(first.template begin<PreOrder>(), first.template end<PreOrder>(), second.template begin<PreOrder>())
+        && std::equal(first.template begin<PostOrder>(), first.template end<PostOrder>(), second.template begin<PostOrder>());
+}
+
+template<typename Balancing>
+void CheckCopyKeepsShape() {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, Balancing>;
+    Tree tree;
+    std::mt19937 generator(7);
+    for (int i = 0; i < 3000; ++i) {
+        tree.insert(static_cast<int>(generator() % 5000));
+    }
+
+    Tree copy(tree);
+    ASSERT_TRUE(SameShape(tree, copy));
+
+    Tree assigned {1, 2, 3};
+    assigned = tree;
+    ASSERT_TRUE(SameShape(tree, assigned));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PostOrder>(assigned)));
+
+    for (int i = 0; i < 5000; i += 3) {
+        copy.erase(i);
+        copy.insert(i + 5000);
+    }
+    ASSERT_TRUE(tree == assigned);
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PreOrder>(copy)));
+}
+
+TEST(bstTestSuite, CopyKeepsShapeTest) {
+    CheckCopyKeepsShape<Unbalanced>();
+    CheckCopyKeepsShape<RedBlack>();
+    CheckCopyKeepsShape<AVL>();
+    CheckCopyKeepsShape<Treap>();
+    CheckCopyKeepsShape<Splay>();
+    CheckCopyKeepsShape<Scapegoat>();
+}
+
+TEST(bstTestSuite, CopyDegenerateTreeTest) {
+    UnbalancedTree<int> tree;
+    for (int i = 0; i < 3000; ++i) {
+        tree.insert(i);
+    }
+    UnbalancedTree<int> copy = tree;
+
+    ASSERT_TRUE(SameShape(tree, copy));
+    ASSERT_EQ(*copy.begin<PreOrder>(), 0);
+    ASSERT_EQ(*copy.begin<PostOrder>(), 2999);
+}
+
+BinarySearchTree<int> MakeTree(int size) {
+    BinarySearchTree<int> tree;
+    FillTree(tree, size);
+    return tree;
+}
+
+TEST(bstTestSuite, MoveConstructorTest) {
+    BinarySearchTree<int> source = MakeTree(1000);
+    const int* smallest = &*source.begin();
+
+    BinarySearchTree<int> target(std::move(source));
+    ASSERT_EQ(&*target.begin(), smallest);
+    ASSERT_EQ(target.size(), 1000);
+    ASSERT_TRUE((TraversalIsConsistent<BinarySearchTree<int>, PostOrder>(target)));
+
+    ASSERT_TRUE(source.empty());
+    ASSERT_TRUE(source.begin() == source.end());
+    source.insert(5);
+    ASSERT_EQ(*source.begin<PreOrder>(), 5);
+
+    BinarySearchTree<int> empty_target(BinarySearchTree<int>{});
+    ASSERT_TRUE(empty_target.begin<PostOrder>() == empty_target.end<PostOrder>());
+}
+
+TEST(bstTestSuite, MoveAssignmentTest) {
+    BinarySearchTree<int> target {1, 2, 3};
+    BinarySearchTree<int> source = MakeTree(100);
+    const int* largest = &*source.rbegin();
+
+    target = std::move(source);
+    ASSERT_EQ(&*target.rbegin(), largest);
+    ASSERT_EQ(target.size(), 100);
+    ASSERT_TRUE(source.empty());
+
+    target = std::move(target);
+    ASSERT_EQ(target.size(), 100);
+
+    source = std::move(target);
+    target = MakeTree(10);
+    ASSERT_EQ(source.size(), 100);
+    ASSERT_EQ(*target.rbegin(), 9);
+}
+
+template<typename T>
+struct TaggedAllocator: std::allocator<T> {
+    using propagate_on_container_move_assignment = std::false_type;
+    using is_always_equal = std::false_type;
+
+    int tag = 0;
+
+    template<typename U>
+    struct rebind {
+        using other = TaggedAllocator<U>;
+    };
+
+    TaggedAllocator() = default;
+
+    template<typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other): tag(other.tag) {}
+
+    bool operator==(const TaggedAllocator& other) const {
+        return tag == other.tag;
+    }
+};
+
+TEST(bstTestSuite, MoveAssignmentUnequalAllocatorTest) {
+    using Tree = BinarySearchTree<int, std::less<int>, TaggedAllocator<int>>;
+    Tree source {5, 1, 3};
+    Tree target;
+    target.alloc_.tag = 1;
+
+    const int* smallest = &*source.begin();
+    target = std::move(source);
+    ASSERT_NE(&*target.begin(), smallest);
+    ASSERT_EQ(target.alloc_.tag, 1);
+    ASSERT_EQ(target.size(), 3);
+
+    Tree same_allocator;
+    smallest = &*target.begin();
+    same_allocator.alloc_.tag = 1;
+    same_allocator = std::move(target);
+    ASSERT_EQ(&*same_allocator.begin(), smallest);
+}
+
+template<typename Balancing>
+void CheckBuildFromSorted() {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, Balancing>;
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(i * 2);
+        keys.push_back(i * 2);
+    }
+
+    Tree tree = Tree::from_sorted(keys.begin(), keys.end());
+    ASSERT_EQ(tree.size(), 1000);
+    ASSERT_EQ(*tree.begin(), 0);
+    ASSERT_EQ(*tree.template begin<PreOrder>(), 1000);
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PreOrder>(tree)));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PostOrder>(tree)));
+
+    std::set<int> set(keys.begin(), keys.end());
+    std::mt19937 generator(3);
+    for (int i = 0; i < 5000; ++i) {
+        int key = static_cast<int>(generator() % 3000);
+        if (i % 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE((TraversalIsConsistent<Tree, PostOrder>(tree)));
+}
+
+TEST(bstTestSuite, BuildFromSortedTest) {
+    CheckBuildFromSorted<Unbalanced>();
+    CheckBuildFromSorted<RedBlack>();
+    CheckBuildFromSorted<AVL>();
+    CheckBuildFromSorted<Treap>();
+    CheckBuildFromSorted<Splay>();
+    CheckBuildFromSorted<Scapegoat>();
+}
+
+struct CountingLess {
+    static inline int calls = 0;
+
+    bool operator()(int first, int second) const {
+        ++calls;
+        return first < second;
+    }
+};
+
+TEST(bstTestSuite, SortedRangeConstructorTest) {
+    std::vector<int> keys(100000);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    CountingLess::calls = 0;
+    BinarySearchTree<int, CountingLess> tree(keys.begin(), keys.end());
+    ASSERT_LE(CountingLess::calls, 2 * 100000);
+    ASSERT_EQ(tree.size(), 100000);
+    ASSERT_EQ(*tree.begin<PreOrder>(), 50000);
+    ASSERT_EQ(*tree.begin<PostOrder>(), 0);
+
+    BinarySearchTree<int> empty_tree(assume_sorted, keys.begin(), keys.begin());
+    ASSERT_TRUE(empty_tree.empty());
+    ASSERT_TRUE(empty_tree.begin<PostOrder>() == empty_tree.end<PostOrder>());
+}
+
+struct DestructionCounter {
+    static inline int destroyed = 0;
+
+    int value;
+
+    DestructionCounter(int value): value(value) {}
+
+    DestructionCounter(const DestructionCounter&) = default;
+
+    ~DestructionCounter() {
+        ++destroyed;
+    }
+
+    bool operator<(const DestructionCounter& other) const {
+        return value < other.value;
+    }
+};
+
+TEST(bstTestSuite, ClearDestroysEveryNodeOnceTest) {
+    BinarySearchTree<DestructionCounter> tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.emplace(i);
+    }
+    DestructionCounter::destroyed = 0;
+
+    tree.clear();
+    ASSERT_EQ(DestructionCounter::destroyed, 1000);
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.begin<PreOrder>() == tree.end<PreOrder>());
+
+    tree.emplace(1);
+    ASSERT_EQ(tree.begin()->value, 1);
+}
+
+TEST(bstTestSuite, ClearDegenerateTreeTest) {
+    UnbalancedTree<int> tree;
+    for (int i = 200000; i > 0; --i) {
+        tree.insert(i);
+    }
+    ASSERT_EQ(*tree.begin<PostOrder>(), 1);
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+
+    tree.insert({2, 1, 3});
+    tree.erase(tree.begin(), tree.end());
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(bstTestSuite, EraseByIteratorDoesNotCompareTest) {
+    std::vector<int> keys(10000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+    BinarySearchTree<int, CountingLess> tree(keys.begin(), keys.end());
+    std::set<int> set(keys.begin(), keys.end());
+
+    CountingLess::calls = 0;
+    for (auto it = tree.begin(); it != tree.end();) {
+        if (*it % 3) {
+            it = tree.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ASSERT_EQ(CountingLess::calls, 0);
+
+    std::erase_if(set, [](int key) { return key % 3; });
+    ASSERT_EQ(tree.size(), set.size());
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), tree.begin()));
+    ASSERT_EQ(*tree.begin(), 0);
+    ASSERT_TRUE((TraversalIsConsistent<decltype(tree), PostOrder>(tree)));
+}
+
+template<typename Balancing>
+void CheckOrderStatistics() {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, Balancing, OrderStatistics>;
+    Tree tree;
+    std::set<int> set;
+    std::mt19937 generator(11);
+
+    for (int i = 0; i < 6000; ++i) {
+        int key = static_cast<int>(generator() % 3000);
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+
+        if (i % 97 == 0) {
+            int probe = static_cast<int>(generator() % 3000);
+            size_t expected_rank = std::distance(set.begin(), set.lower_bound(probe));
+            ASSERT_EQ(tree.rank(probe), expected_rank);
+            ASSERT_EQ(tree.count_range(probe, probe + 100), std::distance(set.lower_bound(probe), set.lower_bound(probe + 100)));
+            if (expected_rank < set.size()) {
+                ASSERT_EQ(*tree.select(expected_rank), *set.lower_bound(probe));
+            }
+        }
+    }
+
+    ASSERT_TRUE(tree.select(tree.size()) == tree.end());
+    ASSERT_EQ(std::distance(tree.begin(), tree.end()), static_cast<std::ptrdiff_t>(set.size()));
+
+    Tree copy = tree;
+    Tree built = Tree::from_sorted(set.begin(), set.end());
+    ASSERT_EQ(copy.rank(1500), tree.rank(1500));
+    ASSERT_EQ(built.rank(1500), tree.rank(1500));
+}
+
+TEST(bstTestSuite, OrderStatisticsTest) {
+    CheckOrderStatistics<Unbalanced>();
+    CheckOrderStatistics<RedBlack>();
+    CheckOrderStatistics<AVL>();
+    CheckOrderStatistics<Treap>();
+    CheckOrderStatistics<Splay>();
+    CheckOrderStatistics<Scapegoat>();
+}
+
+TEST(bstTestSuite, RandomAccessIteratorTest) {
+    std::vector<int> keys(1000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, RedBlack, OrderStatistics> tree(keys.begin(), keys.end());
+
+    auto it = tree.begin();
+    it += 500;
+    ASSERT_EQ(*it, 500);
+    ASSERT_EQ(*(it - 250), 250);
+    ASSERT_EQ(it[100], 600);
+    ASSERT_EQ(tree.end() - it, 500);
+    ASSERT_TRUE(it + 500 == tree.end());
+    ASSERT_TRUE(tree.begin() < it);
+    ASSERT_EQ(std::distance(tree.find(10), tree.find(990)), 980);
+    ASSERT_EQ(*(tree.end() - 1), 999);
+    ASSERT_EQ(*tree.rbegin(), 999);
+    ASSERT_EQ(tree.rbegin()[10], 989);
+    ASSERT_TRUE(std::binary_search(tree.begin(), tree.end(), 777));
+}
+
+TEST(bstTestSuite, StatsTest) {
+    using StatsTree = BinarySearchTree<int, CountingLess, std::allocator<int>, Unbalanced, NoAugmentation, CollectStats>;
+    static_assert(sizeof(BinarySearchTree<int, CountingLess, std::allocator<int>, Unbalanced>) < sizeof(StatsTree));
+
+    StatsTree tree;
+    CountingLess::calls = 0;
+    for (int key: {3, 1, 5, 0, 2, 4, 6}) {
+        tree.insert(key);
+    }
+    tree.insert(6);
+
+    TreeStats stats = tree.stats();
+    ASSERT_EQ(stats.comparisons, CountingLess::calls);
+    ASSERT_EQ(stats.insert.calls, 8);
+    // новый минимум и новый максимум подвешиваются без спуска
+    ASSERT_EQ(stats.insert.nodes_visited, 0 + 1 + 1 + 1 + 2 + 2 + 1 + 3);
+    ASSERT_EQ(stats.allocations, 7);
+    ASSERT_EQ(stats.deallocations, 0);
+
+    tree.reset_stats();
+    ASSERT_TRUE(tree.find(6) != tree.end());
+    ASSERT_TRUE(tree.find(7) == tree.end());
+    ASSERT_EQ(*tree.lower_bound(2), 2);
+    ASSERT_EQ(*tree.upper_bound(2), 3);
+    stats = tree.stats();
+    ASSERT_EQ(stats.find.calls, 2);
+    ASSERT_EQ(stats.find.nodes_visited, 6);
+    ASSERT_EQ(stats.lower_bound.nodes_visited, 3);
+    ASSERT_EQ(stats.upper_bound.nodes_visited, 3);
+    ASSERT_EQ(stats.max_depth, 3);
+    ASSERT_EQ(stats.depth_histogram[3], 4);
+
+    tree.erase(3);
+    tree.clear();
+    ASSERT_EQ(tree.stats().deallocations, 7);
+}
+
+template<typename balancing_type>
+void CheckBatchedSearch() {
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, balancing_type> tree;
+    std::set<int> set;
+    std::mt19937 generator(3);
+    for (int i = 0; i < 2000; ++i) {
+        int key = generator() % 10000;
+        tree.insert(key * 2);
+        set.insert(key * 2);
+    }
+
+    // длина не кратна группе, чтобы проверить неполную последнюю группу
+    std::vector<int> keys;
+    for (int i = -3; i < 20005; i += 3) {
+        keys.push_back(i);
+    }
+    std::vector<decltype(tree.end())> found(keys.size());
+    std::vector<decltype(tree.end())> lower(keys.size());
+    std::unique_ptr<bool[]> contained(new bool[keys.size()]);
+    tree.find_many(keys, std::span(found));
+    tree.lower_bound_many(keys, std::span(lower));
+    tree.contains_many(keys, std::span(contained.get(), keys.size()));
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(found[i] != tree.end(), set.contains(keys[i]));
+        ASSERT_EQ(contained[i], set.contains(keys[i]));
+        auto expected = set.lower_bound(keys[i]);
+        ASSERT_EQ(lower[i] == tree.end(), expected == set.end());
+        if (expected != set.end()) {
+            ASSERT_EQ(*lower[i], *expected);
+        }
+    }
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+}
+
+TEST(bstTestSuite, BatchedSearchTest) {
+    CheckBatchedSearch<Unbalanced>();
+    CheckBatchedSearch<RedBlack>();
+    CheckBatchedSearch<Splay>();
+
+    BinarySearchTree<int> empty;
+    std::vector<int> keys = {1, 2, 3};
+    std::vector<decltype(empty.end())> found(keys.size());
+    empty.find_many(keys, std::span(found));
+    ASSERT_TRUE(std::all_of(found.begin(), found.end(), [&](auto it) { return it == empty.end(); }));
+}
+
+template<typename balancing_type>
+void CheckHintedInsert() {
+    using Tree = BinarySearchTree<int, CountingLess, std::allocator<int>, balancing_type>;
+    Tree tree;
+    std::set<int> set;
+    std::mt19937 generator(5);
+
+    // почти отсортированный поток: подсказка - конец дерева или только что вставленный ключ
+    auto hint = tree.end();
+    for (int i = 0; i < 3000; ++i) {
+        int key = i * 4 + static_cast<int>(generator() % 9) - 4;
+        hint = i % 2 ? tree.insert(tree.end(), key) : tree.insert(hint, key);
+        ASSERT_EQ(*hint, key);
+        set.insert(key);
+    }
+    // подсказки, которые не подходят, и уже существующие ключи
+    for (int i = 0; i < 500; ++i) {
+        int key = static_cast<int>(generator() % 13000);
+        auto it = tree.emplace_hint(tree.find(static_cast<int>(generator() % 12000)), key);
+        ASSERT_EQ(*it, key);
+        set.insert(key);
+    }
+    ASSERT_EQ(tree.size(), set.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+
+    // вставка в конец с верной подсказкой делает O(1) сравнений
+    Tree sorted;
+    CountingLess::calls = 0;
+    for (int i = 0; i < 1000; ++i) {
+        sorted.insert(sorted.end(), i);
+    }
+    ASSERT_LE(CountingLess::calls, 1000);
+    ASSERT_EQ(*sorted.rbegin(), 999);
+    ASSERT_EQ(sorted.size(), 1000);
+}
+
+TEST(bstTestSuite, HintedInsertTest) {
+    CheckHintedInsert<Unbalanced>();
+    CheckHintedInsert<RedBlack>();
+    CheckHintedInsert<AVL>();
+    CheckHintedInsert<Treap>();
+    CheckHintedInsert<Splay>();
+    CheckHintedInsert<Scapegoat>();
+}
+
+TEST(bstTestSuite, AppendMaximumTest) {
+    BinarySearchTree<int, CountingLess> tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i);
+    }
+    CountingLess::calls = 0;
+    tree.insert(100);
+    ASSERT_EQ(CountingLess::calls, 2);
+
+    // после удаления максимума быстрый путь опирается на новый максимум
+    tree.erase(100);
+    tree.erase(99);
+    ASSERT_EQ(*tree.rbegin(), 98);
+    CountingLess::calls = 0;
+    tree.insert(99);
+    ASSERT_EQ(CountingLess::calls, 2);
+
+    BinarySearchTree<int, CountingLess> copy = tree;
+    copy.insert(200);
+    ASSERT_EQ(*copy.rbegin(), 200);
+    swap(tree, copy);
+    tree.insert(300);
+    ASSERT_EQ(*tree.rbegin(), 300);
+    ASSERT_EQ(*copy.rbegin(), 99);
+}
+
+template<typename balancing_type>
+void CheckCursor() {
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, balancing_type> tree;
+    std::set<int> set;
+    for (int i = 0; i < 5000; ++i) {
+        tree.insert(i * 3);
+        set.insert(i * 3);
+    }
+
+    auto cursor = tree.cursor();
+    std::mt19937 generator(11);
+    int position = 7000;
+    for (int i = 0; i < 20000; ++i) {
+        // в основном короткие шаги, иногда прыжок через все дерево и ключи за границами
+        position += i % 100 == 0 ? static_cast<int>(generator() % 20000) - 10000 : static_cast<int>(generator() % 41) - 20;
+        position = std::clamp(position, -10, 15010);
+        auto lower = cursor.lower_bound(position);
+        auto expected = set.lower_bound(position);
+        ASSERT_EQ(lower == tree.end(), expected == set.end());
+        if (expected != set.end()) {
+            ASSERT_EQ(*lower, *expected);
+        }
+        ASSERT_EQ(cursor.find(position) != tree.end(), set.contains(position));
+        ASSERT_EQ(cursor.contains(position + 1), set.contains(position + 1));
+    }
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+}
+
+TEST(bstTestSuite, CursorTest) {
+    CheckCursor<Unbalanced>();
+    CheckCursor<RedBlack>();
+    CheckCursor<Splay>();
+    CheckCursor<Scapegoat>();
+
+    BinarySearchTree<int> empty;
+    ASSERT_TRUE(empty.cursor().find(1) == empty.end());
+    ASSERT_TRUE(empty.cursor().position() == empty.end());
+
+    BinarySearchTree<int> tree = {1, 5, 9};
+    auto cursor = tree.cursor(tree.find(5));
+    ASSERT_EQ(*cursor.position(), 5);
+    ASSERT_TRUE(cursor.lower_bound(10) == tree.end());
+    ASSERT_EQ(*cursor.position(), 5);
+    ASSERT_EQ(*cursor.lower_bound(-1), 1);
+    ASSERT_EQ(*cursor.position(), 1);
+}
+
+TEST(bstTestSuite, CursorLocalityTest) {
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, RedBlack, NoAugmentation, CollectStats> tree;
+    for (int i = 0; i < (1 << 16); ++i) {
+        tree.insert(i);
+    }
+
+    tree.reset_stats();
+    auto cursor = tree.cursor();
+    for (int i = 0; i < (1 << 16); ++i) {
+        ASSERT_EQ(*cursor.find(i), i);
+    }
+    // последовательный проход - амортизированно O(1) нод на поиск против ~16 при спуске от корня
+    TreeStats stats = tree.stats();
+    ASSERT_LT(stats.lower_bound.nodes_visited, 4 * stats.lower_bound.calls);
+}
+
+template<typename Tree>
+void ExpectSameKeys(const Tree& tree, const std::set<int>& set) {
+    ASSERT_EQ(tree.size(), set.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+    ASSERT_EQ(std::distance(tree.template begin<PostOrder>(), tree.template end<PostOrder>()), set.size());
+}
+
+template<typename balancing_type, typename augmentation_type = NoAugmentation>
+void CheckSetAlgebra(int first_size, int second_size) {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, balancing_type, augmentation_type, CollectStats>;
+    std::mt19937 generator(first_size * 31 + second_size);
+    std::set<int> first_set;
+    std::set<int> second_set;
+    while (first_set.size() < static_cast<size_t>(first_size)) {
+        first_set.insert(generator() % (4 * first_size + 4 * second_size));
+    }
+    while (second_set.size() < static_cast<size_t>(second_size)) {
+        second_set.insert(generator() % (4 * first_size + 4 * second_size));
+    }
+    const Tree first(first_set.begin(), first_set.end());
+    const Tree second(second_set.begin(), second_set.end());
+
+    std::set<int> expected;
+    std::set_union(first_set.begin(), first_set.end(), second_set.begin(), second_set.end(), std::inserter(expected, expected.end()));
+    Tree tree = first;
+    tree.union_with(second);
+    ExpectSameKeys(tree, expected);
+
+    expected.clear();
+    std::set_intersection(first_set.begin(), first_set.end(), second_set.begin(), second_set.end(), std::inserter(expected, expected.end()));
+    tree = first;
+    tree.intersect_with(second);
+    ExpectSameKeys(tree, expected);
+
+    expected.clear();
+    std::set_difference(first_set.begin(), first_set.end(), second_set.begin(), second_set.end(), std::inserter(expected, expected.end()));
+    tree = first;
+    tree.difference_with(second);
+    ExpectSameKeys(tree, expected);
+
+    // merge перевешивает ноды: новых выделений нет, дубликаты остаются в источнике
+    tree = first;
+    Tree source = second;
+    tree.reset_stats();
+    tree.merge(source);
+    ASSERT_EQ(tree.stats().allocations, 0);
+    expected.clear();
+    std::set_union(first_set.begin(), first_set.end(), second_set.begin(), second_set.end(), std::inserter(expected, expected.end()));
+    ExpectSameKeys(tree, expected);
+    expected.clear();
+    std::set_intersection(first_set.begin(), first_set.end(), second_set.begin(), second_set.end(), std::inserter(expected, expected.end()));
+    ExpectSameKeys(source, expected);
+
+    // дерево после операций остается рабочим: вставки и удаления по краям и в середине
+    if (!tree.empty()) {
+        tree.erase(*std::next(tree.begin(), tree.size() / 2));
+    }
+    tree.insert(-1);
+    tree.insert(1 << 30);
+    ASSERT_EQ(*tree.begin(), -1);
+    ASSERT_EQ(*tree.rbegin(), 1 << 30);
+}
+
+template<typename balancing_type>
+void CheckSplitJoin(int size) {
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, balancing_type, NoAugmentation, CollectStats>;
+    std::set<int> set;
+    for (int i = 0; i < size; ++i) {
+        set.insert(i * 2);
+    }
+
+    // разрез у края, в середине и за границами
+    for (int key: {-5, 0, 3, size / 2, size, 2 * size - 3, 2 * size - 2, 2 * size + 7}) {
+        Tree tree(set.begin(), set.end());
+        tree.reset_stats();
+        Tree upper = tree.split(key);
+        ExpectSameKeys(tree, std::set<int>(set.begin(), set.lower_bound(key)));
+        ExpectSameKeys(upper, std::set<int>(set.lower_bound(key), set.end()));
+
+        Tree joined = Tree::join(std::move(tree), std::move(upper));
+        ASSERT_EQ(joined.stats().allocations, 0);
+        ASSERT_TRUE(tree.empty());
+        ASSERT_TRUE(upper.empty());
+        ExpectSameKeys(joined, set);
+        joined.insert(-1);
+        joined.erase(0);
+        ASSERT_EQ(*joined.begin(), -1);
+    }
+}
+
+TEST(bstTestSuite, SetAlgebraTest) {
+    // пустые, соизмеримые и сильно разные по размеру деревья
+    for (auto [first_size, second_size]: {std::pair{0, 0}, {0, 50}, {50, 0}, {300, 400}, {3000, 20}, {20, 3000}}) {
+        CheckSetAlgebra<Unbalanced>(first_size, second_size);
+        CheckSetAlgebra<RedBlack>(first_size, second_size);
+        CheckSetAlgebra<AVL>(first_size, second_size);
+        CheckSetAlgebra<Treap>(first_size, second_size);
+        CheckSetAlgebra<Splay>(first_size, second_size);
+        CheckSetAlgebra<Scapegoat>(first_size, second_size);
+        CheckSetAlgebra<RedBlack, OrderStatistics>(first_size, second_size);
+    }
+
+    BinarySearchTree<int, std::less<int>, std::allocator<int>, RedBlack, OrderStatistics> tree = {1, 3, 5, 7};
+    tree.union_with({2, 4, 6});
+    ASSERT_EQ(tree.rank(5), 4);
+    ASSERT_EQ(*tree.select(2), 3);
+}
+
+TEST(bstTestSuite, SetAlgebraWalksSmallerTreeTest) {
+    // сравнения в обоих деревьях: поиск идет в большем, а меньшее только обходится
+    using Tree = BinarySearchTree<int, std::less<int>, std::allocator<int>, RedBlack, NoAugmentation, CollectStats>;
+    std::vector<int> keys(100000);
+    std::iota(keys.begin(), keys.end(), 0);
+    Tree large(keys.begin(), keys.end());
+    Tree small = {5, 17, 40000, 40001, 99999, 100005};
+    const size_t limit = small.size() * 2 * 64;
+
+    Tree tree = large;
+    tree.reset_stats();
+    small.reset_stats();
+    tree.intersect_with(small);
+    ASSERT_LT(tree.stats().comparisons + small.stats().comparisons, limit);
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), std::vector<int>{5, 17, 40000, 40001, 99999}.begin()));
+    ASSERT_EQ(tree.size(), 5);
+
+    tree = small;
+    tree.reset_stats();
+    large.reset_stats();
+    tree.difference_with(large);
+    ASSERT_LT(tree.stats().comparisons + large.stats().comparisons, limit);
+    ASSERT_EQ(tree.size(), 1);
+    ASSERT_EQ(*tree.begin(), 100005);
+}
+
+TEST(bstTestSuite, SplitJoinTest) {
+    for (int size: {1, 2, 100, 2000}) {
+        CheckSplitJoin<Unbalanced>(size);
+        CheckSplitJoin<RedBlack>(size);
+        CheckSplitJoin<AVL>(size);
+        CheckSplitJoin<Treap>(size);
+        CheckSplitJoin<Splay>(size);
+        CheckSplitJoin<Scapegoat>(size);
+    }
+}
+
+template<typename Tree>
+void CheckParallelScan(const Tree& tree, WorkStealingPool& pool) {
+    std::atomic<int64_t> sum = 0;
+    std::atomic<size_t> count = 0;
+    tree.parallel_for_each([&](int key) {
+        sum.fetch_add(key, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+    }, pool);
+    ASSERT_EQ(count.load(), tree.size());
+    ASSERT_EQ(sum.load(), std::accumulate(tree.begin(), tree.end(), int64_t(0)));
+
+    // операция ассоциативна, но не коммутативна: склейка отрезков видит, в каком порядке пришли ключи
+    struct Run {
+        int first;
+        int last;
+        bool sorted;
+    };
+    auto concatenate = [](Run left, Run right) {
+        return Run{left.first, right.last, left.sorted && right.sorted && left.last < right.first};
+    };
+    Run run = tree.parallel_reduce(Run{-1, -1, true}, concatenate, [](int key) { return Run{key, key, true}; }, pool);
+    ASSERT_TRUE(run.sorted);
+    ASSERT_EQ(run.first, -1);
+    ASSERT_EQ(run.last, tree.empty() ? -1 : *std::prev(tree.end()));
+
+    ASSERT_EQ(parallel_reduce(tree, int64_t(7), std::plus<>()), sum.load() + 7);
+}
+
+TEST(bstTestSuite, ParallelScanTest) {
+    WorkStealingPool pool(4);
+    for (size_t size: {0, 1, 100, 50000, 300000}) {
+        std::vector<int> keys(size);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(size));
+        CheckParallelScan(BinarySearchTree<int>(keys.begin(), keys.end()), pool);
+        CheckParallelScan(BinarySearchTree<int, std::less<int>, std::allocator<int>, AVL>(keys.begin(), keys.end()), pool);
+        CheckParallelScan(BinarySearchTree<int, std::less<int>, std::allocator<int>, Treap>(keys.begin(), keys.end()), pool);
+    }
+
+    // вырожденное дерево: разбиение по глубине дает неравные задачи, но результат тот же
+    UnbalancedTree<int> degenerate;
+    for (int i = 40000; i > 0; --i) {
+        degenerate.insert(i);
+    }
+    CheckParallelScan(degenerate, pool);
+
+    BinarySearchTree<int> tree = {1, 2, 3};
+    std::atomic<int> sum = 0;
+    parallel_for_each(tree, [&](int key) { sum += key; });
+    ASSERT_EQ(sum.load(), 6);
+}
+
+struct ConcurrentDestructionCounter {
+    static inline std::atomic<int64_t> destroyed = 0;
+    static inline std::atomic<int64_t> destroyed_sum = 0;
+
+    int value;
+
+    ConcurrentDestructionCounter(int value): value(value) {}
+
+    ~ConcurrentDestructionCounter() {
+        destroyed.fetch_add(1, std::memory_order_relaxed);
+        destroyed_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    bool operator<(const ConcurrentDestructionCounter& other) const {
+        return value < other.value;
+    }
+};
+
+TEST(bstTestSuite, ParallelClearTest) {
+    WorkStealingPool pool(4);
+    BinarySearchTree<ConcurrentDestructionCounter> tree;
+    const int size = 100000;
+    for (int i = 0; i < size; ++i) {
+        tree.emplace(i);
+    }
+    ConcurrentDestructionCounter::destroyed = 0;
+    ConcurrentDestructionCounter::destroyed_sum = 0;
+
+    tree.clear(pool);
+    ASSERT_EQ(ConcurrentDestructionCounter::destroyed.load(), size);
+    ASSERT_EQ(ConcurrentDestructionCounter::destroyed_sum.load(), int64_t(size) * (size - 1) / 2);
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.begin<PostOrder>() == tree.end<PostOrder>());
+
+    tree.emplace(5);
+    tree.emplace(3);
+    ASSERT_EQ(tree.begin()->value, 3);
+    tree.clear(pool);
+    ASSERT_TRUE(tree.empty());
+}
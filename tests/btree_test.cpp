@@ -0,0 +1,247 @@
+#include <lib/btree.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+template<typename Tree, typename Set>
+bool EqualToSet(const Tree& tree, const Set& set) {
+    return tree.size() == set.size() && std::equal(tree.begin(), tree.end(), set.begin(), set.end());
+}
+
+template<typename T>
+void FillSmartly(T& cont, int i_max = 1000, int left = 0, int right = 1000) {
+    int mid = (left + right) / 2;
+    cont.insert(mid);
+    if (left >= right - i_max / 20) {
+        return;
+    }
+    FillSmartly(cont, i_max, mid, right);
+    FillSmartly(cont, i_max, left, mid);
+}
+
+TEST(btreeTestSuite, EmptyTest) {
+    BTree<int> a;
+    ASSERT_TRUE(a.empty());
+    ASSERT_TRUE(a.begin() == a.end());
+    a.insert(123);
+    ASSERT_FALSE(a.empty());
+    a.erase(123);
+    ASSERT_TRUE(a.empty());
+    ASSERT_TRUE(a.begin() == a.end());
+}
+
+TEST(btreeTestSuite, ConstructorsTest) {
+    BTree<int> a;
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(i);
+    }
+    BTree<int> b(a);
+    BTree<int> c = a;
+    c = b;
+    ASSERT_TRUE(a == b);
+    ASSERT_TRUE(b == c);
+
+    BTree<int> d = std::move(c);
+    ASSERT_TRUE(c.empty());
+    ASSERT_TRUE(d == a);
+    a.insert(-1);
+    ASSERT_TRUE(a != d);
+
+    BTree e {1, 2, 3, 4, -1, -2, -3};
+    ASSERT_EQ(*e.begin(), -3);
+    ASSERT_EQ(*e.rbegin(), 4);
+}
+
+TEST(btreeTestSuite, InsertEraseSizeTest) {
+    BTree<int> tree;
+    std::set<int> set;
+    FillSmartly(tree);
+    FillSmartly(set);
+
+    for (int i = 5; i < 567; i += 2) {
+        ASSERT_EQ(tree.erase(i), set.erase(i));
+        ASSERT_EQ(tree.erase(i), set.erase(i));
+        if (i % 74 == 0) {
+            ASSERT_EQ(tree.insert(i).second, set.insert(i).second);
+            ASSERT_EQ(tree.insert(i).second, set.insert(i).second);
+        }
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+}
+
+TEST(btreeTestSuite, IteratorTest) {
+    BTree<int> tree;
+    std::set<int> set;
+    for (int i = 0; i < 5000; ++i) {
+        tree.insert(i * 7 % 5000);
+        set.insert(i * 7 % 5000);
+    }
+
+    auto tree_it = tree.insert(123).first;
+    auto set_it = set.insert(123).first;
+    ASSERT_EQ(*tree_it, *set_it);
+    ASSERT_EQ(*++tree_it, *++set_it);
+    ASSERT_EQ(*--tree_it, *--set_it);
+
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+    ASSERT_EQ(*std::prev(tree.end()), 4999);
+    ASSERT_TRUE(std::next(tree.find(4999)) == tree.end());
+}
+
+TEST(btreeTestSuite, EndSurvivesModificationTest) {
+    BTree<int> tree;
+    auto finish = tree.end();
+    // вставки в конец меняют и заполненность, и сам самый правый лист
+    for (int i = 0; i < 5000; ++i) {
+        tree.insert(i);
+        ASSERT_TRUE(finish == tree.end());
+    }
+    ASSERT_EQ(*std::prev(finish), 4999);
+
+    for (int i = 4999; i >= 2500; --i) {
+        tree.erase(i);
+        ASSERT_TRUE(finish == tree.end());
+    }
+    ASSERT_EQ(*std::prev(finish), 2499);
+    ASSERT_TRUE(std::next(tree.find(2499)) == finish);
+    ASSERT_TRUE(tree.lower_bound(2500) == finish);
+
+    tree.clear();
+    ASSERT_TRUE(finish == tree.end());
+    ASSERT_TRUE(tree.begin() == finish);
+}
+
+TEST(btreeTestSuite, BoundsTest) {
+    BTree<int> tree;
+    std::set<int> set;
+    for (int i = 0; i < 3000; i += 3) {
+        tree.insert(i);
+        set.insert(i);
+    }
+
+    for (int i = -2; i < 3005; ++i) {
+        auto lower = tree.lower_bound(i);
+        auto upper = tree.upper_bound(i);
+        ASSERT_EQ(lower == tree.end(), set.lower_bound(i) == set.end());
+        ASSERT_EQ(upper == tree.end(), set.upper_bound(i) == set.end());
+        if (lower != tree.end()) {
+            ASSERT_EQ(*lower, *set.lower_bound(i));
+        }
+        if (upper != tree.end()) {
+            ASSERT_EQ(*upper, *set.upper_bound(i));
+        }
+        ASSERT_EQ(tree.contains(i), set.contains(i));
+        ASSERT_TRUE(tree.equal_range(i) == std::make_pair(lower, upper));
+    }
+}
+
+TEST(btreeTestSuite, EraseByIteratorTest) {
+    BTree<int> tree;
+    std::set<int> set;
+    for (int i = 0; i < 3000; ++i) {
+        tree.insert(i);
+        set.insert(i);
+    }
+
+    auto tree_it = tree.find(100);
+    auto set_it = set.find(100);
+    while (tree_it != tree.end()) {
+        tree_it = tree.erase(tree_it);
+        set_it = set.erase(set_it);
+        if (tree_it != tree.end()) {
+            ASSERT_EQ(*tree_it, *set_it);
+            ++tree_it;
+            ++set_it;
+        }
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+
+    tree.erase(tree.find(10), tree.find(50));
+    set.erase(set.find(10), set.find(50));
+    ASSERT_TRUE(EqualToSet(tree, set));
+
+    tree.erase(tree.begin(), tree.end());
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(btreeTestSuite, SwapTest) {
+    BTree<int> tree = {1, 2, 3};
+    BTree<int> tree2;
+    FillSmartly(tree2);
+    std::set<int> set2;
+    FillSmartly(set2);
+
+    swap(tree, tree2);
+    ASSERT_TRUE(EqualToSet(tree, set2));
+    ASSERT_TRUE(EqualToSet(tree2, std::set<int>{1, 2, 3}));
+}
+
+template<typename Key, typename MakeKey>
+void CheckRandomOperations(MakeKey make_key) {
+    BTree<Key> tree;
+    std::set<Key> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 5000);
+
+    for (int i = 0; i < 60000; ++i) {
+        Key key = make_key(distribution(generator));
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else if (i % 3 == 1) {
+            ASSERT_EQ(tree.contains(key), set.contains(key));
+            ASSERT_EQ(tree.lower_bound(key) == tree.end(), set.lower_bound(key) == set.end());
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+        ASSERT_EQ(tree.size(), set.size());
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+
+    BTree<Key> copy = tree;
+    while (!tree.empty()) {
+        tree.erase(tree.begin());
+    }
+    ASSERT_TRUE(EqualToSet(copy, set));
+}
+
+TEST(btreeTestSuite, RandomOperationsTest) {
+    CheckRandomOperations<int>([](int value) { return value; });
+    CheckRandomOperations<std::string>([](int value) { return std::to_string(value); });
+}
+
+inline size_t allocated_bytes = 0;
+
+template<typename T>
+struct ByteCountingAllocator: std::allocator<T> {
+    template<typename U>
+    struct rebind {
+        using other = ByteCountingAllocator<U>;
+    };
+
+    ByteCountingAllocator() = default;
+
+    template<typename U>
+    ByteCountingAllocator(const ByteCountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        allocated_bytes += count * sizeof(T);
+        return std::allocator<T>::allocate(count);
+    }
+};
+
+TEST(btreeTestSuite, CompactLayoutTest) {
+    std::vector<int> keys(100000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    allocated_bytes = 0;
+    BTree<int, std::less<int>, ByteCountingAllocator<int>> tree(keys.begin(), keys.end());
+    ASSERT_EQ(tree.size(), keys.size());
+    // узел бинарного дерева для int занимает 32 байта
+    ASSERT_LT(allocated_bytes, keys.size() * 32 / 4);
+}
@@ -0,0 +1,189 @@
+#include <lib/compact_bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+
+static_assert(CompactBinarySearchTree<int>::kSlotSize == 16);
+static_assert(CompactBinarySearchTree<int, std::less<int>, std::allocator<int>, NoParentLinks>::kSlotSize == 12);
+
+template<typename Tree, typename Set>
+bool EqualToSet(const Tree& tree, const Set& set) {
+    return tree.size() == set.size() && std::equal(tree.begin(), tree.end(), set.begin(), set.end());
+}
+
+TEST(compactTestSuite, ConstructorsTest) {
+    CompactBinarySearchTree<int> a;
+    ASSERT_TRUE(a.empty());
+    ASSERT_TRUE(a.begin() == a.end());
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(i);
+    }
+    CompactBinarySearchTree<int> b(a);
+    CompactBinarySearchTree<int> c;
+    c = b;
+    ASSERT_TRUE(a == b);
+    ASSERT_TRUE(b == c);
+
+    CompactBinarySearchTree<int> d = std::move(c);
+    ASSERT_TRUE(c.empty());
+    ASSERT_TRUE(d == a);
+    a.insert(-1);
+    ASSERT_TRUE(a != d);
+
+    CompactBinarySearchTree e {1, 2, 3, 4, -1, -2, -3};
+    ASSERT_EQ(*e.begin(), -3);
+    ASSERT_EQ(*e.rbegin(), 4);
+    ASSERT_EQ(*std::prev(e.end()), 4);
+}
+
+template<typename Key, typename link_type, typename MakeKey>
+void CheckRandomOperations(MakeKey make_key) {
+    CompactBinarySearchTree<Key, std::less<Key>, std::allocator<Key>, link_type> tree;
+    std::set<Key> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 3000);
+
+    for (int i = 0; i < 30000; ++i) {
+        Key key = make_key(distribution(generator));
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else if (i % 3 == 1) {
+            ASSERT_EQ(tree.contains(key), set.contains(key));
+            auto lower = tree.lower_bound(key);
+            auto upper = tree.upper_bound(key);
+            ASSERT_EQ(lower == tree.end(), set.lower_bound(key) == set.end());
+            ASSERT_EQ(upper == tree.end(), set.upper_bound(key) == set.end());
+            if (upper != tree.end()) {
+                ASSERT_EQ(*upper, *set.upper_bound(key));
+            }
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+        ASSERT_EQ(tree.size(), set.size());
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+
+    auto copy = tree;
+    auto tree_it = tree.find(*std::next(set.begin(), set.size() / 2));
+    auto set_it = set.find(*tree_it);
+    while (tree_it != tree.end()) {
+        tree_it = tree.erase(tree_it);
+        set_it = set.erase(set_it);
+        ASSERT_EQ(tree_it == tree.end(), set_it == set.end());
+        if (tree_it != tree.end()) {
+            ASSERT_EQ(*tree_it, *set_it);
+        }
+    }
+    ASSERT_TRUE(EqualToSet(tree, set));
+    ASSERT_TRUE(std::includes(copy.begin(), copy.end(), tree.begin(), tree.end()));
+
+    copy.clear();
+    ASSERT_TRUE(copy.empty());
+    copy.insert(make_key(7));
+    ASSERT_EQ(*copy.begin(), make_key(7));
+}
+
+TEST(compactTestSuite, RandomOperationsTest) {
+    CheckRandomOperations<int, ParentLinks>([](int value) { return value; });
+    CheckRandomOperations<int, NoParentLinks>([](int value) { return value; });
+    CheckRandomOperations<std::string, ParentLinks>([](int value) { return std::to_string(value); });
+    CheckRandomOperations<std::string, NoParentLinks>([](int value) { return std::to_string(value); });
+}
+
+TEST(compactTestSuite, SortedInsertDepthTest) {
+    // вставка по возрастанию вырождает несбалансированное дерево, scapegoat должен перестраивать его
+    CompactBinarySearchTree<int> tree;
+    for (int i = 0; i < 100000; ++i) {
+        tree.insert(i);
+    }
+    ASSERT_EQ(tree.size(), 100000);
+    ASSERT_EQ(*tree.begin(), 0);
+    ASSERT_EQ(*tree.rbegin(), 99999);
+    for (int i = 99999; i >= 0; i -= 2) {
+        ASSERT_EQ(tree.erase(i), 1);
+    }
+    ASSERT_EQ(tree.size(), 50000);
+    ASSERT_EQ(*tree.rbegin(), 99998);
+}
+
+TEST(compactTestSuite, SerializeTest) {
+    CompactBinarySearchTree<int, std::less<int>, std::allocator<int>, NoParentLinks> tree;
+    for (int i = 0; i < 5000; ++i) {
+        tree.insert(i * 7 % 5000);
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        tree.erase(i);
+    }
+
+    std::stringstream stream;
+    tree.serialize(stream);
+    auto loaded = decltype(tree)::deserialize(stream);
+    ASSERT_TRUE(stream);
+    ASSERT_TRUE(loaded == tree);
+    // свободные ячейки тоже переживают сериализацию
+    loaded.insert(0);
+    loaded.insert(3);
+    ASSERT_EQ(loaded.size(), tree.size() + 2);
+
+    std::stringstream broken("garbage");
+    auto empty = decltype(tree)::deserialize(broken);
+    ASSERT_FALSE(broken);
+    ASSERT_TRUE(empty.empty());
+}
+
+TEST(compactTestSuite, DeserializeCorruptedTest) {
+    using Tree = CompactBinarySearchTree<int, std::less<int>, std::allocator<int>, NoParentLinks>;
+    Tree tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(i * 7 % 1000);
+    }
+    for (int i = 0; i < 1000; i += 5) {
+        tree.erase(i);
+    }
+    std::stringstream stream;
+    tree.serialize(stream);
+    const std::string bytes = stream.str();
+
+    // заголовок: slot_size, used, free, size, max_size, begin; за ним ячейки, первая - фиктивная с корнем в left
+    constexpr size_t kUsedOffset = 8;
+    constexpr size_t kSizeOffset = 16;
+    constexpr size_t kSlotsOffset = 36;
+    auto patch = [&](size_t offset, auto value) {
+        std::string patched = bytes;
+        std::memcpy(patched.data() + offset, &value, sizeof(value));
+        return patched;
+    };
+    auto rejects = [](const std::string& data) {
+        std::stringstream in(data);
+        auto loaded = Tree::deserialize(in);
+        return !in && loaded.empty();
+    };
+
+    ASSERT_TRUE(rejects(bytes.substr(0, bytes.size() - 1)));
+    ASSERT_TRUE(rejects(patch(kSizeOffset, uint64_t{tree.size() + 1})));
+    ASSERT_TRUE(rejects(patch(kSizeOffset, uint64_t{tree.size() - 1})));
+    ASSERT_TRUE(rejects(patch(kUsedOffset, uint32_t{0xfffffffe})));
+    ASSERT_TRUE(rejects(patch(kUsedOffset, uint32_t{2})));
+    // корень за пределами массива и корень, ссылающийся сам на себя
+    ASSERT_TRUE(rejects(patch(kSlotsOffset, uint32_t{1u << 30})));
+    uint32_t root;
+    std::memcpy(&root, bytes.data() + kSlotsOffset, sizeof(root));
+    ASSERT_TRUE(rejects(patch(kSlotsOffset + root * Tree::kSlotSize, root)));
+    ASSERT_TRUE(rejects(patch(kSlotsOffset + root * Tree::kSlotSize + 4, root)));
+
+    std::stringstream intact(bytes);
+    ASSERT_TRUE(Tree::deserialize(intact) == tree);
+
+    CompactBinarySearchTree<int> cleared = {1, 2, 3};
+    cleared.clear();
+    std::stringstream empty_stream;
+    cleared.serialize(empty_stream);
+    auto empty = decltype(cleared)::deserialize(empty_stream);
+    ASSERT_TRUE(empty_stream);
+    ASSERT_TRUE(empty.empty());
+}
@@ -0,0 +1,254 @@
+#include <lib/concurrent_bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(concurrentTestSuite, RandomOperationsTest) {
+    ConcurrentBinarySearchTree<int> tree;
+    std::set<int> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 3000);
+
+    for (int i = 0; i < 30000; ++i) {
+        int key = distribution(generator);
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else if (i % 3 == 1) {
+            ASSERT_EQ(tree.contains(key), set.contains(key));
+            auto lower = tree.lower_bound(key);
+            auto upper = tree.upper_bound(key);
+            ASSERT_EQ(lower.has_value(), set.lower_bound(key) != set.end());
+            ASSERT_EQ(upper.has_value(), set.upper_bound(key) != set.end());
+            if (lower) {
+                ASSERT_EQ(*lower, *set.lower_bound(key));
+            }
+            if (upper) {
+                ASSERT_EQ(*upper, *set.upper_bound(key));
+            }
+        } else {
+            ASSERT_EQ(tree.insert(key), set.insert(key).second);
+        }
+        ASSERT_EQ(tree.size(), set.size());
+    }
+
+    std::vector<int> keys;
+    tree.for_each([&keys](int key) { keys.push_back(key); });
+    ASSERT_TRUE(std::equal(keys.begin(), keys.end(), set.begin(), set.end()));
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_FALSE(tree.find(0));
+    ASSERT_TRUE(tree.emplace(7));
+    ASSERT_EQ(tree.find(7), 7);
+}
+
+TEST(concurrentTestSuite, SortedInsertTest) {
+    ConcurrentBinarySearchTree<std::string> tree;
+    for (int i = 0; i < 20000; ++i) {
+        tree.insert(std::to_string(100000 + i));
+    }
+    for (int i = 0; i < 20000; i += 2) {
+        ASSERT_EQ(tree.erase(std::to_string(100000 + i)), 1);
+    }
+    ASSERT_EQ(tree.size(), 10000);
+    ASSERT_EQ(tree.lower_bound("100000"), "100001");
+    ASSERT_FALSE(tree.upper_bound("119999"));
+}
+
+TEST(concurrentTestSuite, ReadersWithWriterTest) {
+    // четные ключи есть всегда, нечетные вставляются и удаляются писателем, отрицательных нет никогда
+    constexpr int kKeys = 2000;
+    ConcurrentBinarySearchTree<int> tree;
+    for (int key = 0; key < kKeys; key += 2) {
+        tree.insert(key);
+    }
+
+    std::atomic<bool> stop = false;
+    std::atomic<int> errors = 0;
+    std::vector<std::thread> readers;
+    for (int thread = 0; thread < 4; ++thread) {
+        readers.emplace_back([&tree, &stop, &errors, thread] {
+            std::mt19937 generator(thread);
+            std::uniform_int_distribution<int> distribution(-kKeys, kKeys - 1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                int key = distribution(generator);
+                bool found = tree.contains(key);
+                if ((key >= 0 && key % 2 == 0 && !found) || (key < 0 && found)) {
+                    ++errors;
+                }
+                auto lower = tree.lower_bound(key & ~1);
+                if (key >= 0 && lower != (key & ~1)) {
+                    ++errors;
+                }
+            }
+        });
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, kKeys / 2 - 1);
+    for (int i = 0; i < 200000; ++i) {
+        int key = distribution(generator) * 2 + 1;
+        if (i % 2) {
+            tree.insert(key);
+        } else {
+            tree.erase(key);
+        }
+    }
+    stop = true;
+    for (auto& reader: readers) {
+        reader.join();
+    }
+    ASSERT_EQ(errors, 0);
+
+    int previous = -1;
+    size_t count = 0;
+    tree.for_each([&](int key) {
+        ASSERT_LT(previous, key);
+        previous = key;
+        ++count;
+    });
+    ASSERT_EQ(count, tree.size());
+}
+
+TEST(concurrentTestSuite, WritersStressTest) {
+    // у каждого писателя свои нечетные ключи и своя модель; ключи от kKeys и выше общие, за ними следит только порядок
+    constexpr int kKeys = 4000;
+    constexpr int kWriters = 4;
+    ConcurrentBinarySearchTree<int> tree;
+    for (int key = 0; key < kKeys; key += 2) {
+        tree.insert(key);
+    }
+
+    std::atomic<bool> stop = false;
+    std::atomic<int> errors = 0;
+    std::thread reader([&tree, &stop, &errors] {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> distribution(0, kKeys / 2 - 1);
+        while (!stop.load(std::memory_order_relaxed)) {
+            int key = distribution(generator) * 2;
+            if (!tree.contains(key) || tree.lower_bound(key) != key) {
+                ++errors;
+            }
+        }
+    });
+
+    std::vector<std::set<int>> models(kWriters);
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < kWriters; ++writer) {
+        writers.emplace_back([&tree, &models, writer] {
+            std::mt19937 generator(writer);
+            std::uniform_int_distribution<int> own(0, kKeys / 2 / kWriters - 1);
+            std::uniform_int_distribution<int> shared(kKeys, kKeys + 200);
+            std::set<int>& model = models[writer];
+            for (int i = 0; i < 50000; ++i) {
+                int key = own(generator) * 2 * kWriters + 2 * writer + 1;
+                if (generator() % 2) {
+                    ASSERT_EQ(tree.insert(key), model.insert(key).second);
+                } else {
+                    ASSERT_EQ(tree.erase(key), model.erase(key));
+                }
+                if (i % 4 == 0) {
+                    int common = shared(generator);
+                    if (generator() % 2) {
+                        tree.insert(common);
+                    } else {
+                        tree.erase(common);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& writer: writers) {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+    ASSERT_EQ(errors, 0);
+
+    std::set<int> expected;
+    for (int key = 0; key < kKeys; key += 2) {
+        expected.insert(key);
+    }
+    for (auto& model: models) {
+        expected.insert(model.begin(), model.end());
+    }
+    std::vector<int> keys;
+    tree.for_each([&keys](int key) { keys.push_back(key); });
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    ASSERT_TRUE(std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+    ASSERT_EQ(keys.size(), tree.size());
+    auto shared_begin = std::lower_bound(keys.begin(), keys.end(), kKeys);
+    ASSERT_TRUE(std::equal(keys.begin(), shared_begin, expected.begin(), expected.end()));
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+}
+
+// первый читатель засыпает между чтением эпохи и регистрацией, пока тест не разрешит продолжить
+struct StallFirstReader {
+    static inline std::atomic<int> stage = 0;
+
+    static void BeforeRegister() {
+        if (stage.load() == 0) {
+            stage = 1;
+            while (stage.load() != 2) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+TEST(concurrentTestSuite, EpochReaderStalledBeforeRegisterTest) {
+    // читатель прочитал эпоху и заснул, synchronize тем временем переключил ее и никого не дождался.
+    // Проснувшийся читатель обязан попасть в счетчик, который ждет следующий synchronize
+    EpochDomain<StallFirstReader> domain;
+    std::atomic<int>& stage = StallFirstReader::stage;
+
+    std::atomic<bool> release = false;
+    std::thread reader([&] {
+        auto guard = domain.pin();
+        stage = 3;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (stage.load() != 1) {
+        std::this_thread::yield();
+    }
+    domain.synchronize();
+    stage = 2;
+    while (stage.load() != 3) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<bool> synchronized = false;
+    std::thread writer([&] {
+        domain.synchronize();
+        synchronized = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(synchronized.load());
+
+    release = true;
+    reader.join();
+    writer.join();
+    ASSERT_TRUE(synchronized.load());
+}
+
+TEST(concurrentTestSuite, InlineStackGrowsTest) {
+    InlineStack<int, 4> stack;
+    for (int i = 0; i < 1000; ++i) {
+        stack.Put(i, i * 3);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(stack[i], i * 3);
+    }
+    ASSERT_EQ(stack.data()[999], 2997);
+}
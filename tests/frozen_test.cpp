@@ -0,0 +1,85 @@
+#include <lib/bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+template<typename Frozen>
+void CheckAgainstSorted(const Frozen& frozen, const std::vector<int>& keys, int max_query) {
+    ASSERT_EQ(frozen.size(), keys.size());
+    ASSERT_TRUE(std::equal(frozen.begin(), frozen.end(), keys.begin()));
+    ASSERT_TRUE(std::equal(frozen.rbegin(), frozen.rend(), keys.rbegin()));
+
+    for (int query = -1; query <= max_query + 1; ++query) {
+        auto expected_lower = std::lower_bound(keys.begin(), keys.end(), query);
+        auto expected_upper = std::upper_bound(keys.begin(), keys.end(), query);
+        auto lower = frozen.lower_bound(query);
+        auto upper = frozen.upper_bound(query);
+
+        ASSERT_EQ(std::distance(frozen.begin(), lower), expected_lower - keys.begin());
+        ASSERT_EQ(std::distance(frozen.begin(), upper), expected_upper - keys.begin());
+        ASSERT_EQ(frozen.contains(query), std::binary_search(keys.begin(), keys.end(), query));
+        ASSERT_TRUE(frozen.equal_range(query) == std::make_pair(lower, upper));
+    }
+}
+
+// freeze() для int отдает StaticBTree, поэтому раскладку Эйтцингера строим напрямую
+template<typename Tree>
+FrozenBinarySearchTree<int> FreezeAsEytzinger(const Tree& tree) {
+    return FrozenBinarySearchTree<int>(assume_sorted, tree.begin(), tree.end());
+}
+
+TEST(frozenTestSuite, EmptyTest) {
+    BinarySearchTree<int> tree;
+    auto frozen = FreezeAsEytzinger(tree);
+    ASSERT_TRUE(frozen.empty());
+    ASSERT_TRUE(frozen.begin() == frozen.end());
+    ASSERT_TRUE(frozen.find(0) == frozen.end());
+    ASSERT_TRUE(frozen.lower_bound(0) == frozen.end());
+}
+
+TEST(frozenTestSuite, MatchesSortedArrayTest) {
+    // полные и неполные нижние уровни неявного дерева
+    for (int size: {1, 2, 3, 7, 8, 15, 16, 17, 100, 1000}) {
+        std::vector<int> keys(size);
+        for (int i = 0; i < size; ++i) {
+            keys[i] = 2 * i;
+        }
+        CheckAgainstSorted(FrozenBinarySearchTree<int>(assume_sorted, keys.begin(), keys.end()), keys, 2 * size);
+    }
+}
+
+TEST(frozenTestSuite, SnapshotIsIndependentTest) {
+    BinarySearchTree<int> tree = {5, 1, 3};
+    auto frozen = FreezeAsEytzinger(tree);
+    tree.erase(3);
+    tree.insert(4);
+
+    ASSERT_TRUE(frozen.contains(3));
+    ASSERT_FALSE(frozen.contains(4));
+
+    auto copy = frozen;
+    frozen = FreezeAsEytzinger(tree);
+    ASSERT_TRUE(copy.contains(3));
+    ASSERT_TRUE(frozen.contains(4));
+    ASSERT_EQ(*copy.upper_bound(3), 5);
+}
+
+TEST(frozenTestSuite, CustomComparatorTest) {
+    BinarySearchTree<std::string, std::greater<std::string>> tree = {"b", "d", "a", "c"};
+    auto frozen = tree.freeze();
+
+    ASSERT_EQ(*frozen.begin(), "d");
+    ASSERT_EQ(*frozen.lower_bound("bb"), "b");
+    ASSERT_EQ(*frozen.upper_bound("c"), "b");
+    ASSERT_TRUE(frozen.find("e") == frozen.end());
+    ASSERT_EQ(frozen.count("a"), 1);
+}
+
+TEST(frozenTestSuite, BuildFromSortedRangeTest) {
+    std::vector<int> keys(31);
+    std::iota(keys.begin(), keys.end(), 0);
+    FrozenBinarySearchTree<int> frozen(assume_sorted, keys.begin(), keys.end());
+    CheckAgainstSorted(frozen, keys, 31);
+}
@@ -0,0 +1,143 @@
+#include <lib/persistent_bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t live_nodes = 0;
+
+template<typename T>
+struct LiveCountingAllocator {
+    using value_type = T;
+
+    LiveCountingAllocator() = default;
+
+    template<typename U>
+    LiveCountingAllocator(const LiveCountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        live_nodes += count;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        live_nodes -= count;
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    bool operator==(const LiveCountingAllocator&) const = default;
+};
+
+}
+
+TEST(persistentTestSuite, VersionsTest) {
+    // каждая версия должна остаться такой, какой была в момент создания
+    using Tree = PersistentBinarySearchTree<int>;
+    std::vector<Tree> versions(1);
+    std::vector<std::set<int>> models(1);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 500);
+
+    for (int i = 0; i < 3000; ++i) {
+        int key = distribution(generator);
+        const Tree& last = versions.back();
+        std::set<int> model = models.back();
+        if (i % 3 == 2) {
+            versions.push_back(last.erase(key));
+            model.erase(key);
+        } else {
+            versions.push_back(last.insert(key));
+            model.insert(key);
+        }
+        models.push_back(std::move(model));
+        ASSERT_EQ(versions.back().contains(key), models.back().contains(key));
+    }
+    for (size_t i = 0; i < versions.size(); i += 97) {
+        const Tree& tree = versions[i];
+        const std::set<int>& model = models[i];
+        ASSERT_EQ(tree.size(), model.size());
+        ASSERT_TRUE(std::equal(tree.begin(), tree.end(), model.begin(), model.end()));
+        ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), model.rbegin(), model.rend()));
+        for (int key = -1; key <= 501; key += 7) {
+            auto lower = model.lower_bound(key);
+            auto upper = model.upper_bound(key);
+            ASSERT_EQ(tree.lower_bound(key) == tree.end(), lower == model.end());
+            ASSERT_EQ(tree.upper_bound(key) == tree.end(), upper == model.end());
+            if (lower != model.end()) {
+                ASSERT_EQ(*tree.lower_bound(key), *lower);
+            }
+            if (upper != model.end()) {
+                ASSERT_EQ(*tree.upper_bound(key), *upper);
+            }
+            ASSERT_EQ(tree.find(key) != tree.end(), model.contains(key));
+        }
+    }
+}
+
+TEST(persistentTestSuite, TraversalTest) {
+    // вставка 1..7 по возрастанию дает в AVL-дереве идеальное дерево с корнем 4
+    PersistentBinarySearchTree<int> tree {1, 2, 3, 4, 5, 6, 7};
+    std::vector<int> in_order(tree.begin(), tree.end());
+    std::vector<int> pre_order(tree.begin<PreOrder>(), tree.end<PreOrder>());
+    std::vector<int> post_order(tree.begin<PostOrder>(), tree.end<PostOrder>());
+    ASSERT_EQ(in_order, std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+    ASSERT_EQ(pre_order, std::vector<int>({4, 2, 1, 3, 6, 5, 7}));
+    ASSERT_EQ(post_order, std::vector<int>({1, 3, 2, 5, 7, 6, 4}));
+
+    auto older = tree;
+    tree = tree.erase(4).insert(8);
+    ASSERT_EQ(std::vector<int>(older.begin<PreOrder>(), older.end<PreOrder>()), pre_order);
+
+    // обратные обходы на неполном дереве
+    for (int key = 9; key < 40; key += 3) {
+        tree = tree.insert(key);
+    }
+    std::vector<int> forward(tree.begin<PreOrder>(), tree.end<PreOrder>());
+    std::vector<int> backward(tree.rbegin<PreOrder>(), tree.rend<PreOrder>());
+    std::reverse(backward.begin(), backward.end());
+    ASSERT_EQ(forward, backward);
+    forward.assign(tree.begin<PostOrder>(), tree.end<PostOrder>());
+    backward.assign(tree.rbegin<PostOrder>(), tree.rend<PostOrder>());
+    std::reverse(backward.begin(), backward.end());
+    ASSERT_EQ(forward, backward);
+    ASSERT_EQ(forward.back(), *tree.begin<PreOrder>());
+    ASSERT_EQ(forward.size(), tree.size());
+}
+
+TEST(persistentTestSuite, SharingTest) {
+    using Tree = PersistentBinarySearchTree<std::string, std::less<std::string>, LiveCountingAllocator<std::string>>;
+    {
+        Tree tree;
+        for (int i = 0; i < 4096; ++i) {
+            tree = tree.insert(std::to_string(i));
+        }
+        ASSERT_EQ(live_nodes, 4096);
+
+        Tree snapshot = tree;
+        ASSERT_EQ(live_nodes, 4096);
+        ASSERT_TRUE(snapshot == tree);
+
+        // обновление копирует только путь: высота дерева из 4096 ключей не больше 17
+        Tree updated = tree.insert("new").erase("100");
+        ASSERT_LE(live_nodes, 4096 + 2 * 17 + 6);
+        ASSERT_EQ(updated.size(), 4096);
+        ASSERT_TRUE(updated.contains("new"));
+        ASSERT_FALSE(updated.contains("100"));
+        ASSERT_TRUE(tree.contains("100"));
+        ASSERT_FALSE(updated == tree);
+
+        // повторная вставка существующего ключа не порождает нод
+        size_t before = live_nodes;
+        Tree same = updated.insert("new");
+        ASSERT_EQ(live_nodes, before);
+
+        tree = Tree();
+        snapshot = Tree();
+        ASSERT_EQ(live_nodes, 4096);
+    }
+    ASSERT_EQ(live_nodes, 0);
+}
@@ -0,0 +1,194 @@
+#include <lib/bst.cpp>
+#include <lib/pool_allocator.cpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <vector>
+
+template<typename Key>
+using PoolTree = BinarySearchTree<Key, std::less<Key>, PoolAllocator<Key>>;
+
+TEST(poolAllocatorTestSuite, ReusesFreedBlocksTest) {
+    NodePool pool(sizeof(int), alignof(int));
+    void* first = pool.allocate();
+    void* second = pool.allocate();
+    ASSERT_NE(first, second);
+
+    pool.deallocate(first);
+    ASSERT_EQ(pool.allocate(), first);
+}
+
+TEST(poolAllocatorTestSuite, BlocksAreContiguousTest) {
+    NodePool pool(24, 8);
+    char* previous = static_cast<char*>(pool.allocate());
+    for (int i = 0; i < 63; ++i) {
+        char* current = static_cast<char*>(pool.allocate());
+        ASSERT_EQ(current - previous, 24);
+        previous = current;
+    }
+}
+
+TEST(poolAllocatorTestSuite, RandomOperationsTest) {
+    PoolTree<int> tree;
+    std::set<int> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 2000);
+
+    for (int i = 0; i < 20000; ++i) {
+        int key = distribution(generator);
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else {
+            ASSERT_EQ(tree.insert(key).second, set.insert(key).second);
+        }
+    }
+
+    ASSERT_EQ(tree.size(), set.size());
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), tree.begin()));
+}
+
+TEST(poolAllocatorTestSuite, ArenaClearTest) {
+    PoolTree<int> tree;
+    for (int i = 0; i < 100000; ++i) {
+        tree.insert(i);
+    }
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.begin() == tree.end());
+    ASSERT_TRUE(tree.begin<PostOrder>() == tree.end<PostOrder>());
+
+    tree.insert({3, 1, 2});
+    ASSERT_EQ(*tree.begin(), 1);
+    ASSERT_EQ(tree.size(), 3);
+}
+
+TEST(poolAllocatorTestSuite, SharedPoolIsNotReleasedTest) {
+    PoolAllocator<int> allocator;
+    PoolAllocator<int> copy = allocator;
+    ASSERT_TRUE(allocator == copy);
+    ASSERT_FALSE(allocator.release());
+
+    PoolAllocator<int> fresh = allocator.select_on_container_copy_construction();
+    ASSERT_FALSE(allocator == fresh);
+    ASSERT_TRUE(fresh.release());
+}
+
+TEST(poolAllocatorTestSuite, CopyAndSwapTest) {
+    PoolTree<std::string> tree {"b", "a", "c"};
+    PoolTree<std::string> copy = tree;
+    tree.clear();
+
+    ASSERT_EQ(copy.size(), 3);
+    ASSERT_EQ(*copy.begin(), "a");
+
+    tree.insert("z");
+    tree.swap(copy);
+    ASSERT_EQ(tree.size(), 3);
+    ASSERT_EQ(*copy.begin(), "z");
+}
+
+TEST(poolAllocatorTestSuite, CopyIsReservedInOneChunkTest) {
+    PoolTree<int> tree;
+    for (int i = 0; i < 5000; ++i) {
+        tree.insert(i);
+    }
+
+    PoolTree<int> copy = tree;
+    const int* smallest = &*copy.begin();
+    const int* largest = &*copy.rbegin();
+    ASSERT_LT(reinterpret_cast<const char*>(largest) - reinterpret_cast<const char*>(smallest), 5000 * 64);
+    ASSERT_EQ(copy.size(), tree.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), copy.begin()));
+}
+
+// все адреса отстоят друг от друга на один и тот же шаг - значит, лежат подряд в одном чанке
+template<typename Pointer>
+bool IsOneContiguousRun(std::vector<Pointer> pointers) {
+    std::sort(pointers.begin(), pointers.end());
+    for (size_t i = 2; i < pointers.size(); ++i) {
+        if (reinterpret_cast<const char*>(pointers[i]) - reinterpret_cast<const char*>(pointers[i - 1]) !=
+            reinterpret_cast<const char*>(pointers[1]) - reinterpret_cast<const char*>(pointers[0])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(poolAllocatorTestSuite, ReserveSkipsFreeListTest) {
+    NodePool pool(sizeof(int), alignof(int));
+    std::vector<void*> old_blocks;
+    for (int i = 0; i < 1000; ++i) {
+        old_blocks.push_back(pool.allocate());
+    }
+    for (size_t i = 0; i < old_blocks.size(); i += 2) {
+        pool.deallocate(old_blocks[i]);
+    }
+
+    pool.reserve(3000);
+    std::vector<void*> reserved;
+    for (int i = 0; i < 3000; ++i) {
+        reserved.push_back(pool.allocate());
+    }
+    ASSERT_TRUE(IsOneContiguousRun(reserved));
+
+    // после резерва снова в ход идут освобожденные блоки
+    ASSERT_EQ(pool.allocate(), old_blocks[old_blocks.size() - 2]);
+}
+
+TEST(poolAllocatorTestSuite, CopyAssignmentIsReservedInOneChunkTest) {
+    // у std::string нетривиальный деструктор, поэтому clear перед копированием кладет ноды в free list
+    PoolTree<std::string> source;
+    PoolTree<std::string> target;
+    for (int i = 0; i < 5000; ++i) {
+        source.insert(std::to_string(i));
+        target.insert(std::to_string(i));
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        target.erase(std::to_string(i));
+    }
+
+    target = source;
+    std::vector<const std::string*> nodes;
+    for (const std::string& key: target) {
+        nodes.push_back(&key);
+    }
+    ASSERT_TRUE(IsOneContiguousRun(nodes));
+    ASSERT_TRUE(std::equal(source.begin(), source.end(), target.begin(), target.end()));
+}
+
+TEST(poolAllocatorTestSuite, RebindSharesPoolTest) {
+    PoolAllocator<int> allocator;
+    PoolAllocator<std::string> rebound(allocator);
+    PoolAllocator<int> back(rebound);
+    ASSERT_TRUE(rebound == allocator);
+    ASSERT_TRUE(back == allocator);
+    ASSERT_FALSE(PoolAllocator<std::string>() == allocator);
+
+    // блок, выделенный одной копией, возвращается через другую и снова выдается первой
+    int* block = allocator.allocate(1);
+    back.deallocate(block, 1);
+    ASSERT_EQ(allocator.allocate(1), block);
+    allocator.deallocate(block, 1);
+
+    std::string* string = rebound.allocate(1);
+    PoolAllocator<std::string>(back).deallocate(string, 1);
+    ASSERT_EQ(rebound.allocate(1), string);
+    rebound.deallocate(string, 1);
+
+    ASSERT_FALSE(allocator.release());
+}
+
+TEST(poolAllocatorTestSuite, MoveKeepsSourceAllocatorTest) {
+    PoolAllocator<int> allocator;
+    PoolAllocator<int> moved = std::move(allocator);
+    ASSERT_TRUE(allocator == moved);
+
+    PoolTree<int> tree {1, 2, 3};
+    PoolTree<int> target = std::move(tree);
+    tree.insert(4);
+    ASSERT_EQ(*tree.begin(), 4);
+    ASSERT_EQ(target.size(), 3);
+}
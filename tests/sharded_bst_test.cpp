@@ -0,0 +1,165 @@
+#include <lib/sharded_bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+template<typename Sharded>
+void CheckRandomOperations(Sharded& tree) {
+    std::set<int> set;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 3000);
+
+    for (int i = 0; i < 30000; ++i) {
+        int key = distribution(generator);
+        if (i % 3 == 2) {
+            ASSERT_EQ(tree.erase(key), set.erase(key));
+        } else if (i % 3 == 1) {
+            ASSERT_EQ(tree.contains(key), set.contains(key));
+            auto lower = set.lower_bound(key);
+            auto upper = set.upper_bound(key);
+            ASSERT_EQ(tree.lower_bound(key), lower == set.end() ? std::nullopt : std::optional<int>(*lower));
+            ASSERT_EQ(tree.upper_bound(key), upper == set.end() ? std::nullopt : std::optional<int>(*upper));
+        } else {
+            ASSERT_EQ(tree.insert(key), set.insert(key).second);
+        }
+        if (i % 5000 == 0) {
+            tree.rebalance();
+        }
+    }
+    ASSERT_EQ(tree.size(), set.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    ASSERT_TRUE(std::equal(tree.rbegin(), tree.rend(), set.rbegin(), set.rend()));
+
+    std::vector<int> keys;
+    tree.for_each([&keys](int key) { keys.push_back(key); });
+    ASSERT_TRUE(std::equal(keys.begin(), keys.end(), set.begin(), set.end()));
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.begin() == tree.end());
+}
+
+TEST(shardedTestSuite, RandomOperationsTest) {
+    ShardedBinarySearchTree<int> by_range(8);
+    CheckRandomOperations(by_range);
+
+    ShardedBinarySearchTree<int> by_splitter(4, [](int key) { return static_cast<size_t>(key / 1000); });
+    CheckRandomOperations(by_splitter);
+
+    ShardedBinarySearchTree<int> single(1);
+    CheckRandomOperations(single);
+}
+
+TEST(shardedTestSuite, RebalanceTest) {
+    ShardedBinarySearchTree<int, std::greater<int>> tree(8);
+    for (int i = 0; i < 10000; ++i) {
+        tree.insert(i);
+    }
+    tree.rebalance();
+    for (size_t index = 0; index < tree.shard_count(); ++index) {
+        ASSERT_EQ(tree.shard_size(index), 1250);
+    }
+    ASSERT_EQ(*tree.begin(), 9999);
+    ASSERT_EQ(*tree.rbegin(), 0);
+    ASSERT_EQ(tree.lower_bound(5000), 5000);
+    ASSERT_EQ(tree.upper_bound(0), std::nullopt);
+
+    // перекос в верхние ключи переносит границы обратно
+    for (int i = 0; i < 10000; i += 2) {
+        tree.erase(i);
+    }
+    for (int i = 10000; i < 20000; ++i) {
+        tree.insert(i);
+    }
+    tree.rebalance();
+    size_t total = 0;
+    for (size_t index = 0; index < tree.shard_count(); ++index) {
+        ASSERT_NEAR(tree.shard_size(index), 15000 / 8, 1);
+        total += tree.shard_size(index);
+    }
+    ASSERT_EQ(total, 15000);
+    ASSERT_TRUE(std::is_sorted(tree.begin(), tree.end(), std::greater<int>()));
+    ASSERT_EQ(std::distance(tree.begin(), tree.end()), 15000);
+}
+
+TEST(shardedTestSuite, BackgroundRebalanceTest) {
+    ShardedBinarySearchTree<int> tree(4);
+    for (int i = 0; i < 20000; ++i) {
+        tree.insert(i);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (tree.shard_size(0) == 20000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(tree.shard_size(0), 5000);
+    ASSERT_EQ(tree.size(), 20000);
+}
+
+TEST(shardedTestSuite, ConcurrentTest) {
+    // писатели в своих диапазонах, перебалансировка в цикле, читатель проверяет неизменные четные ключи
+    constexpr int kKeys = 20000;
+    constexpr int kWriters = 4;
+    ShardedBinarySearchTree<int> tree(8);
+    for (int key = 0; key < kKeys; key += 2) {
+        tree.insert(key);
+    }
+
+    std::atomic<bool> stop = false;
+    std::atomic<int> errors = 0;
+    std::thread reader([&tree, &stop, &errors] {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> distribution(0, kKeys / 2 - 1);
+        while (!stop.load(std::memory_order_relaxed)) {
+            int key = distribution(generator) * 2;
+            if (!tree.contains(key) || tree.lower_bound(key) != key || tree.find(key) != key) {
+                ++errors;
+            }
+        }
+    });
+    std::thread rebalancer([&tree, &stop] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            tree.rebalance();
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::set<int>> models(kWriters);
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < kWriters; ++writer) {
+        writers.emplace_back([&tree, &models, writer] {
+            std::mt19937 generator(writer);
+            // у писателей разная плотность, чтобы границам было куда двигаться
+            std::uniform_int_distribution<int> own(0, kKeys / 2 / kWriters / (writer + 1) - 1);
+            for (int i = 0; i < 20000; ++i) {
+                int key = kKeys / kWriters * writer + own(generator) * 2 + 1;
+                if (generator() % 3) {
+                    ASSERT_EQ(tree.insert(key), models[writer].insert(key).second);
+                } else {
+                    ASSERT_EQ(tree.erase(key), models[writer].erase(key));
+                }
+            }
+        });
+    }
+    for (auto& writer: writers) {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+    rebalancer.join();
+    ASSERT_EQ(errors, 0);
+
+    std::set<int> expected;
+    for (int key = 0; key < kKeys; key += 2) {
+        expected.insert(key);
+    }
+    for (auto& model: models) {
+        expected.insert(model.begin(), model.end());
+    }
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+}
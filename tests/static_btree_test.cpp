@@ -0,0 +1,92 @@
+#include <lib/bst.cpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+static_assert(std::is_same_v<decltype(BinarySearchTree<int>().freeze()), StaticBTree<int>>);
+static_assert(std::is_same_v<decltype(BinarySearchTree<double>().freeze()), StaticBTree<double>>);
+static_assert(std::is_same_v<decltype(BinarySearchTree<int, std::greater<int>>().freeze()), FrozenBinarySearchTree<int, std::greater<int>>>);
+
+template<typename Key>
+void CheckSearch(const std::vector<Key>& keys, const std::vector<Key>& queries) {
+    StaticBTree<Key> index(assume_sorted, keys.begin(), keys.end());
+    ASSERT_TRUE(std::equal(index.begin(), index.end(), keys.begin(), keys.end()));
+
+    for (SimdLevel level: {SimdLevel::kScalar, SimdLevel::kSse, SimdLevel::kAvx2}) {
+        index.set_simd_level(level);
+        for (Key query: queries) {
+            ASSERT_EQ(index.lower_bound(query) - index.begin(), std::lower_bound(keys.begin(), keys.end(), query) - keys.begin());
+            ASSERT_EQ(index.upper_bound(query) - index.begin(), std::upper_bound(keys.begin(), keys.end(), query) - keys.begin());
+            ASSERT_EQ(index.contains(query), std::binary_search(keys.begin(), keys.end(), query));
+        }
+    }
+}
+
+TEST(staticBTreeTestSuite, IntSearchTest) {
+    // один блок, ровно заполненные слои и слои с неполными блоками
+    for (int size: {0, 1, 15, 16, 17, 272, 273, 4913, 10000}) {
+        std::vector<int> keys(size);
+        for (int i = 0; i < size; ++i) {
+            keys[i] = 3 * i - size;
+        }
+        std::vector<int> queries;
+        for (int query = -size - 2; query <= 2 * size + 2; ++query) {
+            queries.push_back(query);
+        }
+        queries.push_back(std::numeric_limits<int>::min());
+        queries.push_back(std::numeric_limits<int>::max());
+        CheckSearch(keys, queries);
+    }
+}
+
+TEST(staticBTreeTestSuite, Uint64SearchTest) {
+    std::mt19937_64 generator(1);
+    std::vector<uint64_t> keys(5000);
+    for (uint64_t& key: keys) {
+        key = generator();
+    }
+    keys.push_back(0);
+    keys.push_back(std::numeric_limits<uint64_t>::max());
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> queries = keys;
+    for (int i = 0; i < 5000; ++i) {
+        queries.push_back(generator());
+    }
+    CheckSearch(keys, queries);
+}
+
+TEST(staticBTreeTestSuite, DoubleSearchTest) {
+    std::vector<double> keys;
+    for (int i = -500; i < 500; ++i) {
+        keys.push_back(i * 0.5);
+    }
+    std::vector<double> queries = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), -0.0, 0.25, 1e9};
+    for (int i = -1100; i < 1100; ++i) {
+        queries.push_back(i * 0.25);
+    }
+    CheckSearch(keys, queries);
+}
+
+TEST(staticBTreeTestSuite, FreezeTest) {
+    BinarySearchTree<int> tree = {40, 10, 30, 20};
+    auto frozen = tree.freeze();
+    tree.clear();
+
+    ASSERT_EQ(frozen.size(), 4);
+    ASSERT_EQ(*frozen.lower_bound(11), 20);
+    ASSERT_EQ(*frozen.upper_bound(30), 40);
+    ASSERT_TRUE(frozen.find(25) == frozen.end());
+    ASSERT_TRUE(frozen.upper_bound(std::numeric_limits<int>::max()) == frozen.end());
+
+    auto moved = std::move(frozen);
+    ASSERT_TRUE(frozen.empty());
+    ASSERT_TRUE(moved.contains(10));
+    frozen = moved;
+    ASSERT_EQ(frozen.simd_level(), moved.simd_level());
+    ASSERT_TRUE(std::equal(frozen.begin(), frozen.end(), moved.begin(), moved.end()));
+}
@@ -0,0 +1,62 @@
+#include <lib/work_stealing_pool.cpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+int64_t ParallelSum(WorkStealingPool& pool, int64_t from, int64_t to) {
+    if (to - from <= 64) {
+        int64_t sum = 0;
+        for (int64_t i = from; i < to; ++i) {
+            sum += i;
+        }
+        return sum;
+    }
+    int64_t middle = from + (to - from) / 2;
+    int64_t left = 0;
+    int64_t right = 0;
+    pool.invoke([&] { left = ParallelSum(pool, from, middle); }, [&] { right = ParallelSum(pool, middle, to); });
+    return left + right;
+}
+
+TEST(WorkStealingPoolTestSuite, NestedInvoke) {
+    for (size_t threads: {1, 2, 4, 8}) {
+        WorkStealingPool pool(threads);
+        ASSERT_EQ(pool.thread_count(), threads);
+        for (int64_t size: {0, 1, 1000, 1000000}) {
+            ASSERT_EQ(ParallelSum(pool, 0, size), size * (size - 1) / 2);
+        }
+    }
+}
+
+TEST(WorkStealingPoolTestSuite, Exceptions) {
+    WorkStealingPool pool(4);
+    std::atomic<int> finished = 0;
+    // обе ветки доводятся до конца, даже если одна из них бросила
+    ASSERT_THROW(pool.invoke([&] { throw std::runtime_error("left"); }, [&] { ++finished; }), std::runtime_error);
+    ASSERT_THROW(pool.invoke([&] { ++finished; }, [&] { throw std::runtime_error("right"); }), std::runtime_error);
+    ASSERT_THROW(pool.run([] { throw std::logic_error("run"); }), std::logic_error);
+    ASSERT_EQ(finished.load(), 2);
+    ASSERT_EQ(ParallelSum(pool, 0, 10000), 10000 * 9999 / 2);
+}
+
+TEST(WorkStealingPoolTestSuite, ExternalThreads) {
+    WorkStealingPool pool(3);
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches = 0;
+    for (int t = 0; t < 6; ++t) {
+        threads.emplace_back([&, t] {
+            for (int64_t i = 0; i < 50; ++i) {
+                int64_t size = 1000 * (t + 1) + i;
+                if (ParallelSum(pool, 0, size) != size * (size - 1) / 2) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    ASSERT_EQ(mismatches.load(), 0);
+}